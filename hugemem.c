@@ -0,0 +1,223 @@
+#define _GNU_SOURCE // for mremap()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "hugemem.h"
+#include "numamem.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT) && !defined(MAP_HUGE_1GB)
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT) // only in <linux/mman.h> with older glibc
+#endif
+#endif
+
+#define HM_ALIGN  (2ULL<<20) // mappings are multiples of 2 MB and start at 2 MB boundaries
+#define HM_GIGA   (1ULL<<30) // blocks of this size or more try 1 GB hugetlb pages first
+#define HM_HEADER 64         // keep the 64-byte alignment of malloc() blocks
+
+#define HM_KIND_MALLOC  0
+#define HM_KIND_THP     1
+#define HM_KIND_HUGETLB 2
+#define HM_KIND_MMAP    3 // normal pages, mapped to apply a NUMA policy
+
+typedef struct {
+	size_t size; // requested size
+	size_t len;  // length of the mapping; 0 for malloc()
+	size_t page; // the mapping can only be split at multiples of this
+	int kind;
+} hm_header_t;
+
+static int hm_mode = HM_NONE;
+static size_t hm_cur[4], hm_max[4], hm_anon_max;
+
+void hm_set_mode(int mode)
+{
+	hm_mode = mode;
+}
+
+static void hm_count(int kind, size_t len, int add)
+{
+	if (add) {
+		hm_cur[kind] += len;
+		if (hm_cur[kind] > hm_max[kind]) hm_max[kind] = hm_cur[kind];
+	} else hm_cur[kind] -= len;
+}
+
+/** Whether a block of size bytes is mapped rather than taken from malloc() */
+static int hm_is_mapped(size_t size)
+{
+	return size >= HM_MIN_SIZE && (hm_mode != HM_NONE || nm_policy() != NM_NONE);
+}
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+/** Map len bytes, a multiple of HM_ALIGN, at a 2 MB boundary with normal pages */
+static uint8_t *hm_reserve(size_t len, int prot)
+{
+	uint8_t *p;
+	size_t head;
+	p = (uint8_t*)mmap(0, len + HM_ALIGN, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED) return 0;
+	head = (HM_ALIGN - (uintptr_t)p % HM_ALIGN) % HM_ALIGN; // trim to the 2 MB boundary
+	if (head) munmap(p, head);
+	munmap(p + head + len, HM_ALIGN - head);
+	return p + head;
+}
+
+/**
+ * Map *len bytes, a multiple of HM_ALIGN, at a 2 MB boundary with the pages
+ * hm_mode asks for. With 1 GB pages, *len is rounded up to a multiple of 1 GB.
+ */
+static void *hm_map(size_t *len, size_t *page, int *kind)
+{
+	uint8_t *p;
+#ifdef MAP_HUGETLB
+	if (hm_mode == HM_HUGETLB) { // hugetlb mappings are always aligned
+#ifdef MAP_HUGE_1GB
+		if (*len >= HM_GIGA) {
+			size_t len1g = (*len + HM_GIGA - 1) / HM_GIGA * HM_GIGA;
+			p = (uint8_t*)mmap(0, len1g, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+			if (p != MAP_FAILED) {
+				nm_place(p, len1g, 0);
+				*len = len1g, *page = HM_GIGA, *kind = HM_KIND_HUGETLB;
+				return p;
+			}
+		}
+#endif
+		p = (uint8_t*)mmap(0, *len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED) {
+			nm_place(p, *len, 0);
+			*page = HM_ALIGN, *kind = HM_KIND_HUGETLB;
+			return p;
+		}
+	}
+#endif
+	if ((p = hm_reserve(*len, PROT_READ | PROT_WRITE)) == 0) return 0;
+	if (hm_mode != HM_NONE) madvise(p, *len, MADV_HUGEPAGE);
+	nm_place(p, *len, 0);
+	*page = HM_ALIGN, *kind = hm_mode != HM_NONE? HM_KIND_THP : HM_KIND_MMAP;
+	return p;
+}
+#endif
+
+void *hm_malloc(size_t size)
+{
+	hm_header_t *h;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (hm_is_mapped(size)) {
+		size_t len = (size + HM_HEADER + HM_ALIGN - 1) / HM_ALIGN * HM_ALIGN, page;
+		int kind;
+		if ((h = (hm_header_t*)hm_map(&len, &page, &kind)) != 0) {
+			h->size = size, h->len = len, h->page = page, h->kind = kind;
+			hm_count(kind, len, 1);
+			return (uint8_t*)h + HM_HEADER;
+		}
+	}
+#endif
+	if ((h = (hm_header_t*)malloc(size + HM_HEADER)) == 0) return 0;
+	h->size = size, h->len = 0, h->page = 0, h->kind = HM_KIND_MALLOC;
+	return (uint8_t*)h + HM_HEADER;
+}
+
+void *hm_calloc(size_t n, size_t size)
+{
+	void *p;
+	hm_header_t *h;
+	if (size && n > SIZE_MAX / size) return 0; // n * size would overflow
+	if ((p = hm_malloc(n * size)) == 0) return 0;
+	h = (hm_header_t*)((uint8_t*)p - HM_HEADER);
+	if (h->kind == HM_KIND_MALLOC) memset(p, 0, n * size); // mappings are zeroed by the kernel
+	return p;
+}
+
+void hm_free(void *p)
+{
+	hm_header_t *h;
+	if (p == 0) return;
+	h = (hm_header_t*)((uint8_t*)p - HM_HEADER);
+#ifdef __linux__
+	if (h->kind != HM_KIND_MALLOC) {
+		if (h->kind == HM_KIND_THP) { // sample before the pages are gone; large blocks are few
+			size_t a = hm_anon_huge();
+			if (a > hm_anon_max) hm_anon_max = a;
+		}
+		nm_note(h, h->len);
+		hm_count(h->kind, h->len, 0);
+		munmap(h, h->len);
+		return;
+	}
+#endif
+	if (h->size >= HM_MIN_SIZE) nm_note(h, h->size);
+	free(h);
+}
+
+void *hm_realloc(void *p, size_t size)
+{
+	hm_header_t *h;
+	void *q;
+	if (p == 0) return hm_malloc(size);
+	h = (hm_header_t*)((uint8_t*)p - HM_HEADER);
+	if (h->kind == HM_KIND_MALLOC) {
+		if (!hm_is_mapped(size)) {
+			if ((h = (hm_header_t*)realloc(h, size + HM_HEADER)) == 0) return 0;
+			h->size = size;
+			return (uint8_t*)h + HM_HEADER;
+		}
+	}
+#ifdef __linux__
+	else {
+		size_t len = (size + HM_HEADER + h->page - 1) / h->page * h->page;
+		if (len <= h->len) { // shrink in place and return the tail to the system
+			if (len < h->len) munmap((uint8_t*)h + len, h->len - len);
+			hm_count(h->kind, h->len - len, 0);
+			h->size = size, h->len = len;
+			return p;
+		}
+#if defined(MREMAP_MAYMOVE) && defined(MREMAP_FIXED) && defined(MADV_HUGEPAGE)
+		if (h->kind == HM_KIND_THP || h->kind == HM_KIND_MMAP) { // the moved mapping keeps MADV_HUGEPAGE
+			hm_header_t *g = (hm_header_t*)mremap(h, h->len, len, 0); // grow in place if the next range is free
+			if (g == MAP_FAILED) { // or move to a reserved 2 MB boundary; plain MREMAP_MAYMOVE may break the alignment
+				uint8_t *r = hm_reserve(len, PROT_NONE);
+				if (r != 0 && (g = (hm_header_t*)mremap(h, h->len, len, MREMAP_MAYMOVE | MREMAP_FIXED, r)) == MAP_FAILED)
+					munmap(r, len);
+			}
+			if (g != MAP_FAILED) {
+				nm_place(g, len, g->len);
+				hm_count(g->kind, len - g->len, 1);
+				g->size = size, g->len = len;
+				return (uint8_t*)g + HM_HEADER;
+			}
+		}
+#endif
+	}
+#endif
+	if ((q = hm_malloc(size)) == 0) return 0;
+	memcpy(q, p, h->size < size? h->size : size);
+	hm_free(p);
+	return q;
+}
+
+void hm_peak(size_t *hugetlb, size_t *thp, size_t *anon_huge)
+{
+	size_t a = hm_anon_huge();
+	*hugetlb = hm_max[HM_KIND_HUGETLB], *thp = hm_max[HM_KIND_THP];
+	*anon_huge = a > hm_anon_max? a : hm_anon_max;
+	hm_max[HM_KIND_HUGETLB] = hm_cur[HM_KIND_HUGETLB], hm_max[HM_KIND_THP] = hm_cur[HM_KIND_THP];
+	hm_anon_max = 0;
+}
+
+size_t hm_anon_huge(void)
+{
+	char buf[256];
+	size_t kb = 0;
+	FILE *fp;
+	if ((fp = fopen("/proc/self/smaps_rollup", "r")) == 0) return 0;
+	while (fgets(buf, sizeof(buf), fp))
+		if (strncmp(buf, "AnonHugePages:", 14) == 0) {
+			kb = strtoull(buf + 14, 0, 10);
+			break;
+		}
+	fclose(fp);
+	return kb * 1024;
+}
@@ -0,0 +1,44 @@
+#ifndef HUGEMEM_H
+#define HUGEMEM_H
+
+#include <stddef.h>
+
+#define HM_NONE    0 // plain malloc(), or normal pages mapped if a NUMA policy is set (see numamem.h)
+#define HM_THP     1 // mmap() advised with MADV_HUGEPAGE for transparent huge pages
+#define HM_HUGETLB 2 // mmap() with MAP_HUGETLB, 1 GB pages for blocks of 1 GB or more; falls back to 2 MB pages, then HM_THP
+
+#define HM_MIN_SIZE (2ULL<<20) // smaller blocks always come from malloc()
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Set how large blocks are allocated from now on; blocks already allocated are not affected */
+void hm_set_mode(int mode);
+
+/*
+ * Drop-in replacements of malloc(), calloc(), realloc() and free(). Blocks
+ * must be freed with hm_free(), whatever the mode they were allocated in.
+ */
+void *hm_malloc(size_t size);
+void *hm_calloc(size_t n, size_t size);
+void *hm_realloc(void *p, size_t size);
+void hm_free(void *p);
+
+/**
+ * Peak usage since the last call
+ *
+ * @param hugetlb    bytes mapped with MAP_HUGETLB
+ * @param thp        bytes mapped with MADV_HUGEPAGE
+ * @param anon_huge  AnonHugePages, sampled now and whenever a THP block is freed
+ */
+void hm_peak(size_t *hugetlb, size_t *thp, size_t *anon_huge);
+
+/** AnonHugePages of this process in bytes, or 0 if unknown */
+size_t hm_anon_huge(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,6 +22,15 @@ Please see the file LICENSE for full copyright information.
 --*/
 
 #include "libsais.h"
+#ifdef SA_PROF
+#include "saprof.h"
+#else
+#define SAPROF_DECL(v)
+#define SAPROF_LAP(v, lib, stage, bytes)  ((void)0)
+#define SAPROF_SKIP(v)                    ((void)0)
+#define SAPROF_ENTER()                    ((void)0)
+#define SAPROF_LEAVE(v)                   ((void)0)
+#endif
 
 #include <stddef.h>
 #include <stdint.h>
@@ -6182,9 +6191,249 @@ static void libsais_clear_lms_suffixes_omp(sa_sint_t * RESTRICT SA, sa_sint_t n,
     }
 }
 
+static sa_sint_t libsais_gsa_bwt_string_index(const sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t p)
+{
+    sa_sint_t l = 0, r = m - 1;
+    while (l < r)
+    {
+        sa_sint_t c = l + ((r - l) >> 1);
+        if ((SA[c] & SAINT_MAX) < p) { l = c + 1; } else { r = c; }
+    }
+
+    return l + 1;
+}
+
+static void libsais_final_gsa_bwt_scan_left_to_right_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, fast_sint_t n, fast_sint_t m, sa_sint_t k, sa_sint_t * RESTRICT induction_bucket, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+    SA[induction_bucket[T[(sa_sint_t)n - 1]]++] = ((sa_sint_t)n - 1) | (sa_sint_t)((sa_uint_t)(T[(sa_sint_t)n - 2] < T[(sa_sint_t)n - 1]) << (SAINT_BIT - 1));
+
+    libsais_final_sorting_scan_left_to_right_8u(T, SA, induction_bucket, 0, m);
+
+    if (threads == 1 || n < 65536)
+    {
+        libsais_final_bwt_scan_left_to_right_8u(T, SA, induction_bucket, m, n - m);
+    }
+#if defined(LIBSAIS_OPENMP)
+    else
+    {
+        fast_sint_t block_start;
+        for (block_start = m; block_start < n; )
+        {
+            if (SA[block_start] == 0)
+            {
+                block_start++;
+            }
+            else
+            {
+                fast_sint_t block_max_end = block_start + ((fast_sint_t)threads) * (LIBSAIS_PER_THREAD_CACHE_SIZE - 16 * (fast_sint_t)threads); if (block_max_end > n) { block_max_end = n;}
+                fast_sint_t block_end     = block_start + 1; while (block_end < block_max_end && SA[block_end] != 0) { block_end++; }
+                fast_sint_t block_size    = block_end - block_start;
+
+                if (block_size < 32)
+                {
+                    for (; block_start < block_end; block_start += 1)
+                    {
+                        sa_sint_t p = SA[block_start]; SA[block_start] = p & SAINT_MAX; if (p > 0) { p--; SA[block_start] = T[p] | SAINT_MIN; SA[induction_bucket[T[p]]++] = p | (sa_sint_t)((sa_uint_t)(T[p - (p > 0)] < T[p]) << (SAINT_BIT - 1)); }
+                    }
+                }
+                else
+                {
+                    libsais_final_bwt_scan_left_to_right_8u_block_omp(T, SA, k, induction_bucket, block_start, block_size, threads, thread_state);
+                    block_start = block_end;
+                }
+            }
+        }
+    }
+#else
+    UNUSED(k); UNUSED(thread_state);
+#endif
+}
+
+static void libsais_final_gsa_bwt_scan_right_to_left_8u(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT induction_bucket, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
+{
+    const fast_sint_t prefetch_distance = 32;
+
+    fast_sint_t i, j;
+    for (i = omp_block_start + omp_block_size - 1, j = omp_block_start + prefetch_distance + 1; i >= j; i -= 2)
+    {
+        libsais_prefetchw(&SA[i - 2 * prefetch_distance]);
+
+        sa_sint_t s0 = SA[i - prefetch_distance - 0]; const uint8_t * Ts0 = &T[s0] - 1; libsais_prefetchr(s0 > 0 ? Ts0 : NULL); Ts0--; libsais_prefetchr(s0 > 0 ? Ts0 : NULL);
+        sa_sint_t s1 = SA[i - prefetch_distance - 1]; const uint8_t * Ts1 = &T[s1] - 1; libsais_prefetchr(s1 > 0 ? Ts1 : NULL); Ts1--; libsais_prefetchr(s1 > 0 ? Ts1 : NULL);
+
+        sa_sint_t p0 = SA[i - 0]; if (p0 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 0); }
+        SA[i - 0] = p0 & SAINT_MAX; if (p0 > 0) { p0--; uint8_t c0 = T[p0 - (p0 > 0)], c1 = T[p0]; SA[i - 0] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p0 : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p0)] = (sa_sint_t)(i - 0); } }
+
+        sa_sint_t p1 = SA[i - 1]; if (p1 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 1); }
+        SA[i - 1] = p1 & SAINT_MAX; if (p1 > 0) { p1--; uint8_t c0 = T[p1 - (p1 > 0)], c1 = T[p1]; SA[i - 1] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p1 : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p1)] = (sa_sint_t)(i - 1); } }
+    }
+
+    for (j -= prefetch_distance + 1; i >= j; i -= 1)
+    {
+        sa_sint_t p = SA[i]; if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+        SA[i] = p & SAINT_MAX; if (p > 0) { p--; uint8_t c0 = T[p - (p > 0)], c1 = T[p]; SA[i] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p)] = (sa_sint_t)i; } }
+    }
+}
+
+#if defined(LIBSAIS_OPENMP)
+
+static fast_sint_t libsais_final_gsa_bwt_scan_right_to_left_8u_block_prepare(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t k, sa_sint_t * RESTRICT buckets, LIBSAIS_THREAD_CACHE * RESTRICT cache, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
+{
+   const fast_sint_t prefetch_distance = 32;
+
+   memset(buckets, 0, (size_t)k * sizeof(sa_sint_t));
+
+   fast_sint_t i, j, count = 0;
+   for (i = omp_block_start + omp_block_size - 1, j = omp_block_start + prefetch_distance + 1; i >= j; i -= 2)
+   {
+       libsais_prefetchw(&SA[i - 2 * prefetch_distance]);
+
+       sa_sint_t s0 = SA[i - prefetch_distance - 0]; const uint8_t * Ts0 = &T[s0] - 1; libsais_prefetchr(s0 > 0 ? Ts0 : NULL); Ts0--; libsais_prefetchr(s0 > 0 ? Ts0 : NULL);
+       sa_sint_t s1 = SA[i - prefetch_distance - 1]; const uint8_t * Ts1 = &T[s1] - 1; libsais_prefetchr(s1 > 0 ? Ts1 : NULL); Ts1--; libsais_prefetchr(s1 > 0 ? Ts1 : NULL);
+
+       sa_sint_t p0 = SA[i - 0]; if (p0 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 0); }
+       SA[i - 0] = p0 & SAINT_MAX; if (p0 > 0) { p0--; uint8_t c0 = T[p0 - (p0 > 0)], c1 = T[p0]; SA[i - 0] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p0 : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p0)] = (sa_sint_t)(i - 0); } }
+
+       sa_sint_t p1 = SA[i - 1]; if (p1 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 1); }
+       SA[i - 1] = p1 & SAINT_MAX; if (p1 > 0) { p1--; uint8_t c0 = T[p1 - (p1 > 0)], c1 = T[p1]; SA[i - 1] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p1 : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p1)] = (sa_sint_t)(i - 1); } }
+   }
+
+   for (j -= prefetch_distance + 1; i >= j; i -= 1)
+   {
+       sa_sint_t p = SA[i]; if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+       SA[i] = p & SAINT_MAX; if (p > 0) { p--; uint8_t c0 = T[p - (p > 0)], c1 = T[p]; SA[i] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p : t; } else if (I != NULL) { I[libsais_gsa_bwt_string_index(SA, m, p)] = (sa_sint_t)i; } }
+   }
+
+   return count;
+}
+
+static void libsais_final_gsa_bwt_scan_right_to_left_8u_block_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t k, sa_sint_t * RESTRICT induction_bucket, fast_sint_t block_start, fast_sint_t block_size, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+#if defined(LIBSAIS_OPENMP)
+    #pragma omp parallel num_threads(threads) if(threads > 1 && block_size >= 64 * (k > 256 ? k : 256) && omp_get_dynamic() == 0)
+#endif
+    {
+#if defined(LIBSAIS_OPENMP)
+        fast_sint_t omp_thread_num    = omp_get_thread_num();
+        fast_sint_t omp_num_threads   = omp_get_num_threads();
+#else
+        UNUSED(k); UNUSED(threads); UNUSED(thread_state);
+
+        fast_sint_t omp_thread_num    = 0;
+        fast_sint_t omp_num_threads   = 1;
+#endif
+        fast_sint_t omp_block_stride  = (block_size / omp_num_threads) & (-16);
+        fast_sint_t omp_block_start   = omp_thread_num * omp_block_stride;
+        fast_sint_t omp_block_size    = omp_thread_num < omp_num_threads - 1 ? omp_block_stride : block_size - omp_block_start;
+
+        omp_block_start += block_start;
+
+        if (omp_num_threads == 1)
+        {
+            libsais_final_gsa_bwt_scan_right_to_left_8u(T, SA, m, I, induction_bucket, omp_block_start, omp_block_size);
+        }
+#if defined(LIBSAIS_OPENMP)
+        else
+        {
+            {
+                thread_state[omp_thread_num].state.count = libsais_final_gsa_bwt_scan_right_to_left_8u_block_prepare(T, SA, m, I, k, thread_state[omp_thread_num].state.buckets, thread_state[omp_thread_num].state.cache, omp_block_start, omp_block_size);
+            }
+
+            #pragma omp barrier
+
+            #pragma omp master
+            {
+                fast_sint_t t;
+                for (t = omp_num_threads - 1; t >= 0; --t)
+                {
+                    sa_sint_t * RESTRICT temp_bucket = thread_state[t].state.buckets;
+                    fast_sint_t c; for (c = 0; c < k; c += 1) { sa_sint_t A = induction_bucket[c], B = temp_bucket[c]; induction_bucket[c] = A - B; temp_bucket[c] = A; }
+                }
+            }
+
+            #pragma omp barrier
+
+            {
+                libsais_final_order_scan_right_to_left_8u_block_place(SA, thread_state[omp_thread_num].state.buckets, thread_state[omp_thread_num].state.cache, thread_state[omp_thread_num].state.count);
+            }
+        }
+#endif
+    }
+}
+
+#endif
+
+static void libsais_final_gsa_bwt_scan_right_to_left_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, fast_sint_t n, fast_sint_t m, sa_sint_t k, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT induction_bucket, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+    if (threads == 1 || n - m < 65536)
+    {
+        libsais_final_gsa_bwt_scan_right_to_left_8u(T, SA, (sa_sint_t)m, I, induction_bucket, m, n - m);
+    }
+#if defined(LIBSAIS_OPENMP)
+    else
+    {
+        fast_sint_t block_start;
+        for (block_start = n - 1; block_start >= m; )
+        {
+            if (SA[block_start] == 0)
+            {
+                if (I != NULL) { I[0] = (sa_sint_t)block_start; }
+                block_start--;
+            }
+            else
+            {
+                fast_sint_t block_max_end = block_start - ((fast_sint_t)threads) * (LIBSAIS_PER_THREAD_CACHE_SIZE - 16 * (fast_sint_t)threads); if (block_max_end < m) { block_max_end = m - 1; }
+                fast_sint_t block_end     = block_start - 1; while (block_end > block_max_end && SA[block_end] != 0) { block_end--; }
+                fast_sint_t block_size    = block_start - block_end;
+
+                if (block_size < 32)
+                {
+                    libsais_final_gsa_bwt_scan_right_to_left_8u(T, SA, (sa_sint_t)m, I, induction_bucket, block_end + 1, block_size);
+                    block_start = block_end;
+                }
+                else
+                {
+                    libsais_final_gsa_bwt_scan_right_to_left_8u_block_omp(T, SA, (sa_sint_t)m, I, k, induction_bucket, block_end + 1, block_size, threads, thread_state);
+                    block_start = block_end;
+                }
+            }
+        }
+    }
+#else
+    UNUSED(k); UNUSED(thread_state);
+#endif
+}
+
+static void libsais_final_gsa_bwt_store_sentinels_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t threads)
+{
+    fast_sint_t i;
+
+#if defined(LIBSAIS_OPENMP)
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1 && m >= 65536)
+#else
+    UNUSED(threads);
+#endif
+    for (i = 0; i < m; ++i)
+    {
+        sa_sint_t p = SA[i] & SAINT_MAX; SA[i] = p > 0 ? T[p - 1] : 0;
+        if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+    }
+}
+
 static sa_sint_t libsais_induce_final_order_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t n, sa_sint_t k, sa_sint_t flags, sa_sint_t r, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT buckets, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
 {
-    if ((flags & LIBSAIS_FLAGS_BWT) == 0)
+    if ((flags & LIBSAIS_FLAGS_BWT) && (flags & LIBSAIS_FLAGS_GSA))
+    {
+        sa_sint_t m = buckets[7 * ALPHABET_SIZE]; buckets[6 * ALPHABET_SIZE] = m - 1;
+
+        libsais_final_gsa_bwt_scan_left_to_right_8u_omp(T, SA, n, m, k, &buckets[6 * ALPHABET_SIZE], threads, thread_state);
+        if (threads > 1 && n >= 65536) { libsais_clear_lms_suffixes_omp(SA, n, ALPHABET_SIZE, &buckets[6 * ALPHABET_SIZE], &buckets[7 * ALPHABET_SIZE], threads); }
+        libsais_final_gsa_bwt_scan_right_to_left_8u_omp(T, SA, n, m, k, I, &buckets[7 * ALPHABET_SIZE], threads, thread_state);
+        libsais_final_gsa_bwt_store_sentinels_omp(T, SA, m, I, threads);
+
+        return m;
+    }
+    else if ((flags & LIBSAIS_FLAGS_BWT) == 0)
     {
         if (flags & LIBSAIS_FLAGS_GSA) { buckets[6 * ALPHABET_SIZE] = buckets[7 * ALPHABET_SIZE] - 1; }
 
@@ -6650,6 +6899,8 @@ static void libsais_reconstruct_compacted_lms_suffixes_32s_1k_omp(sa_sint_t * RE
 
 static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t n, sa_sint_t k, sa_sint_t fs, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state, sa_sint_t * RESTRICT local_buffer)
 {
+    SAPROF_DECL(prof);
+
     fs = fs < (SAINT_MAX - n) ? fs : (SAINT_MAX - n);
 
     if (k > 0 && ((fs / k >= 6) || (LIBSAIS_LOCAL_BUFFER_SIZE / k >= 6 && threads == 1)))
@@ -6673,10 +6924,12 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
 
             libsais_initialize_buckets_for_partial_sorting_32s_6k(T, k, buckets, first_lms_suffix, left_suffixes_count);
             libsais_induce_partial_order_32s_6k_omp(T, SA, n, k, buckets, first_lms_suffix, left_suffixes_count, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = (n / 8192) < k
                 ? libsais_renumber_and_mark_distinct_lms_suffixes_32s_4k_omp(SA, n, m, threads, thread_state)
                 : libsais_renumber_and_gather_lms_suffixes_omp(SA, n, m, fs, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
 
             if (names < m)
             {
@@ -6684,12 +6937,16 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
                     ? libsais_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state)
                     : 0;
 
+                SAPROF_LAP(prof, "libsais", "reduce", (n / 8192) < k ? (int64_t)n * sizeof(sa_sint_t) : 0);
+                SAPROF_ENTER();
                 if (libsais_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6699,6 +6956,7 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
             libsais_initialize_buckets_start_and_end_32s_4k(k, buckets);
             libsais_place_lms_suffixes_histogram_32s_4k(SA, n, k, m, buckets);
             libsais_induce_final_order_32s_4k(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         }
         else
         {
@@ -6707,6 +6965,7 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
             libsais_initialize_buckets_start_and_end_32s_6k(k, buckets);
             libsais_place_lms_suffixes_histogram_32s_6k(SA, n, k, m, buckets);
             libsais_induce_final_order_32s_6k(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         }
 
         return 0;
@@ -6727,18 +6986,24 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
             
             libsais_place_lms_suffixes_interval_32s_4k(SA, n, k, m - 1, buckets);
             libsais_induce_partial_order_32s_4k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais_renumber_and_mark_distinct_lms_suffixes_32s_4k_omp(SA, n, m, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 sa_sint_t f = libsais_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6753,6 +7018,7 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
         libsais_initialize_buckets_start_and_end_32s_4k(k, buckets);
         libsais_place_lms_suffixes_histogram_32s_4k(SA, n, k, m, buckets);
         libsais_induce_final_order_32s_4k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
 
         return 0;
     }
@@ -6772,18 +7038,24 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
 
             libsais_initialize_buckets_start_and_end_32s_2k(k, buckets);
             libsais_induce_partial_order_32s_2k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais_renumber_and_mark_distinct_lms_suffixes_32s_1k_omp(T, SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 sa_sint_t f = libsais_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6800,6 +7072,7 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
 
         libsais_initialize_buckets_start_and_end_32s_2k(k, buckets);
         libsais_induce_final_order_32s_2k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
 
         return 0;
     }
@@ -6821,20 +7094,26 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
         if (m > 1)
         {
             libsais_induce_partial_order_32s_1k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais_renumber_and_mark_distinct_lms_suffixes_32s_1k_omp(T, SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 if (buffer != NULL) { libsais_free_aligned(buffer); buckets = NULL; }
 
                 sa_sint_t f = libsais_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais_reconstruct_compacted_lms_suffixes_32s_1k_omp(T, SA, n, m, fs, f, threads, thread_state);
+                SAPROF_LAP(prof, "libsais", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
 
                 if (buckets == NULL) { buckets = buffer = (sa_sint_t *)libsais_alloc_aligned((size_t)k * sizeof(sa_sint_t), 4096); }
                 if (buckets == NULL) { return -2; }
@@ -6846,6 +7125,7 @@ static sa_sint_t libsais_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t *
         }
 
         libsais_induce_final_order_32s_1k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         libsais_free_aligned(buffer);
 
         return 0;
@@ -6861,6 +7141,8 @@ static sa_sint_t libsais_main_32s_entry(sa_sint_t * RESTRICT T, sa_sint_t * REST
 
 static sa_sint_t libsais_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t * RESTRICT buckets, sa_sint_t flags, sa_sint_t r, sa_sint_t * RESTRICT I, sa_sint_t fs, sa_sint_t * freq, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
 {
+    SAPROF_DECL(prof);
+
     fs = fs < (SAINT_MAX - n) ? fs : (SAINT_MAX - n);
 
     sa_sint_t m = libsais_count_and_gather_lms_suffixes_8u_omp(T, SA, n, buckets, threads, thread_state);
@@ -6882,17 +7164,22 @@ static sa_sint_t libsais_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t n,
 
         libsais_initialize_buckets_for_partial_sorting_8u(T, buckets, first_lms_suffix, left_suffixes_count);
         libsais_induce_partial_order_8u_omp(T, SA, n, k, flags, buckets, first_lms_suffix, left_suffixes_count, threads, thread_state);
+        SAPROF_LAP(prof, "libsais", "sort LMS", (int64_t)n * (3 + 2 * sizeof(sa_sint_t)));
 
         sa_sint_t names = libsais_renumber_and_gather_lms_suffixes_omp(SA, n, m, fs, threads, thread_state);
+        SAPROF_LAP(prof, "libsais", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
         if (names < m)
         {
+            SAPROF_ENTER();
             if (libsais_main_32s_entry(SA + n + fs - m, SA, m, names, fs + n - 2 * m, threads, thread_state) != 0)
             {
                 return -2;
             }
+            SAPROF_LEAVE(prof);
 
             libsais_gather_lms_suffixes_8u_omp(T, SA, n, threads, thread_state);
             libsais_reconstruct_lms_suffixes_omp(SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
         }
 
         libsais_place_lms_suffixes_interval_8u(SA, n, m, flags, buckets);
@@ -6902,7 +7189,10 @@ static sa_sint_t libsais_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t n,
         memset(SA, 0, (size_t)n * sizeof(sa_sint_t));
     }
 
-    return libsais_induce_final_order_8u_omp(T, SA, n, k, flags, r, I, buckets, threads, thread_state);
+    sa_sint_t index = libsais_induce_final_order_8u_omp(T, SA, n, k, flags, r, I, buckets, threads, thread_state);
+    SAPROF_LAP(prof, "libsais", "induce final", (int64_t)n * (2 + 2 * sizeof(sa_sint_t)));
+
+    return index;
 }
 
 static sa_sint_t libsais_main(const uint8_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t flags, sa_sint_t r, sa_sint_t * I, sa_sint_t fs, sa_sint_t * freq, sa_sint_t threads)
@@ -6988,6 +7278,17 @@ static void libsais_bwt_copy_8u_omp(uint8_t * RESTRICT U, sa_sint_t * RESTRICT A
     }
 }
 
+static sa_sint_t libsais_gsa_bwt_main(const uint8_t * T, uint8_t * U, sa_sint_t * A, sa_sint_t n, sa_sint_t fs, sa_sint_t * freq, sa_sint_t * I, sa_sint_t threads)
+{
+    sa_sint_t m = libsais_main(T, A, n, LIBSAIS_FLAGS_BWT | LIBSAIS_FLAGS_GSA, 0, I, fs, freq, threads);
+    if (m >= 0)
+    {
+        libsais_bwt_copy_8u_omp(U, A, n, threads);
+    }
+
+    return m;
+}
+
 void * libsais_create_ctx(void)
 {
     return (void *)libsais_create_ctx_main(1);
@@ -7179,6 +7480,23 @@ int32_t libsais_bwt_aux_ctx(const void * ctx, const uint8_t * T, uint8_t * U, in
     return index;
 }
 
+int32_t libsais_gsa_bwt(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t * I)
+{
+    if ((T == NULL) || (U == NULL) || (A == NULL) || (n <= 0) || (T[n - 1] != 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n == 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int32_t)); freq[0] = 1; }
+        if (I != NULL) { I[0] = 0; }
+        U[0] = 0;
+        return 1;
+    }
+
+    return libsais_gsa_bwt_main(T, U, A, n, fs, freq, I, 1);
+}
+
 #if defined(LIBSAIS_OPENMP)
 
 void * libsais_create_ctx_omp(int32_t threads)
@@ -7297,6 +7615,25 @@ int32_t libsais_bwt_aux_omp(const uint8_t * T, uint8_t * U, int32_t * A, int32_t
     return index;
 }
 
+int32_t libsais_gsa_bwt_omp(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t * I, int32_t threads)
+{
+    if ((T == NULL) || (U == NULL) || (A == NULL) || (n <= 0) || (T[n - 1] != 0) || (fs < 0) || (threads < 0))
+    {
+        return -1;
+    }
+    else if (n == 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int32_t)); freq[0] = 1; }
+        if (I != NULL) { I[0] = 0; }
+        U[0] = 0;
+        return 1;
+    }
+
+    threads = threads > 0 ? threads : omp_get_max_threads();
+
+    return libsais_gsa_bwt_main(T, U, A, n, fs, freq, I, threads);
+}
+
 #endif
 
 static LIBSAIS_UNBWT_CONTEXT * libsais_unbwt_create_ctx_main(sa_sint_t threads)
@@ -195,6 +195,19 @@ extern "C" {
     */
     LIBSAIS_API int32_t libsais_bwt_aux(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t r, int32_t * I);
 
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of given string set.
+    * @param T [0..n-1] The input string set using 0 as separators (T[n-1] must be 0).
+    * @param U [0..n-1] The output string (can be T). Each separator is kept as 0; U[i] is 0 if the i-th suffix is the start of a string.
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string set.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @param I [0..m-1] The output index of the BWT row starting with each of the m strings (can be NULL).
+    * @return The number of strings m if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS_API int32_t libsais_gsa_bwt(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t * I);
+
     /**
     * Constructs the burrows-wheeler transformed string (BWT) of a given string using libsais context.
     * @param ctx The libsais context.
@@ -251,6 +264,20 @@ extern "C" {
     * @return 0 if no error occurred, -1 or -2 otherwise.
     */
     LIBSAIS_API int32_t libsais_bwt_aux_omp(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t r, int32_t * I, int32_t threads);
+
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of given string set in parallel using OpenMP.
+    * @param T [0..n-1] The input string set using 0 as separators (T[n-1] must be 0).
+    * @param U [0..n-1] The output string (can be T). Each separator is kept as 0; U[i] is 0 if the i-th suffix is the start of a string.
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string set.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @param I [0..m-1] The output index of the BWT row starting with each of the m strings (can be NULL).
+    * @param threads The number of OpenMP threads to use (can be 0 for OpenMP default).
+    * @return The number of strings m if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS_API int32_t libsais_gsa_bwt_omp(const uint8_t * T, uint8_t * U, int32_t * A, int32_t n, int32_t fs, int32_t * freq, int32_t * I, int32_t threads);
 #endif
 
     /**
@@ -89,6 +89,7 @@ typedef struct LIBSAIS_CONTEXT
     sa_sint_t *                         buckets;
     LIBSAIS_THREAD_STATE *              thread_state;
     fast_sint_t                         threads;
+    void *                              ctx32;
 } LIBSAIS_CONTEXT;
 
 typedef struct LIBSAIS_UNBWT_CONTEXT
@@ -213,6 +214,45 @@ static void libsais16x64_free_thread_state(LIBSAIS_THREAD_STATE * thread_state)
     }
 }
 
+static LIBSAIS_CONTEXT * libsais16x64_create_ctx_main(sa_sint_t threads)
+{
+    LIBSAIS_CONTEXT *       RESTRICT ctx            = (LIBSAIS_CONTEXT *)libsais16x64_alloc_aligned(sizeof(LIBSAIS_CONTEXT), 64);
+    sa_sint_t *             RESTRICT buckets        = (sa_sint_t *)libsais16x64_alloc_aligned((size_t)8 * ALPHABET_SIZE * sizeof(sa_sint_t), 4096);
+    LIBSAIS_THREAD_STATE *  RESTRICT thread_state   = threads > 1 ? libsais16x64_alloc_thread_state(threads) : NULL;
+#if defined(LIBSAIS_OPENMP)
+    void *                           ctx32          = threads > 1 ? libsais16_create_ctx_omp((int32_t)threads) : libsais16_create_ctx();
+#else
+    void *                           ctx32          = libsais16_create_ctx();
+#endif
+
+    if (ctx != NULL && buckets != NULL && (thread_state != NULL || threads == 1) && ctx32 != NULL)
+    {
+        ctx->buckets = buckets;
+        ctx->threads = threads;
+        ctx->thread_state = thread_state;
+        ctx->ctx32 = ctx32;
+
+        return ctx;
+    }
+
+    libsais16_free_ctx(ctx32);
+    libsais16x64_free_thread_state(thread_state);
+    libsais16x64_free_aligned(buckets);
+    libsais16x64_free_aligned(ctx);
+    return NULL;
+}
+
+static void libsais16x64_free_ctx_main(LIBSAIS_CONTEXT * ctx)
+{
+    if (ctx != NULL)
+    {
+        libsais16_free_ctx(ctx->ctx32);
+        libsais16x64_free_thread_state(ctx->thread_state);
+        libsais16x64_free_aligned(ctx->buckets);
+        libsais16x64_free_aligned(ctx);
+    }
+}
+
 #if defined(LIBSAIS_OPENMP)
 
 static sa_sint_t libsais16x64_count_negative_marked_suffixes(sa_sint_t * RESTRICT SA, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
@@ -6955,6 +6995,13 @@ static sa_sint_t libsais16x64_main(const uint16_t * T, sa_sint_t * SA, sa_sint_t
     return index;
 }
 
+static sa_sint_t libsais16x64_main_ctx(const LIBSAIS_CONTEXT * ctx, const uint16_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t flags, sa_sint_t r, sa_sint_t * I, sa_sint_t fs, sa_sint_t * freq)
+{
+    return ctx != NULL && (ctx->buckets != NULL && (ctx->thread_state != NULL || ctx->threads == 1))
+        ? libsais16x64_main_16u(T, SA, n, ctx->buckets, flags, r, I, fs, freq, (sa_sint_t)ctx->threads, ctx->thread_state)
+        : -2;
+}
+
 static sa_sint_t libsais16x64_main_long(sa_sint_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t k, sa_sint_t fs, sa_sint_t threads)
 {
     LIBSAIS_THREAD_STATE * RESTRICT thread_state = threads > 1 ? libsais16x64_alloc_thread_state(threads) : NULL;
@@ -7016,6 +7063,162 @@ static void libsais16x64_bwt_copy_16u_omp(uint16_t * RESTRICT U, sa_sint_t * RES
     }
 }
 
+void * libsais16x64_create_ctx(void)
+{
+    return (void *)libsais16x64_create_ctx_main(1);
+}
+
+void libsais16x64_free_ctx(void * ctx)
+{
+    libsais16x64_free_ctx_main((LIBSAIS_CONTEXT *)ctx);
+}
+
+int64_t libsais16x64_ctx(const void * ctx, const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (SA == NULL) || (n < 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { SA[0] = 0; if (freq != NULL) { freq[T[0]]++; } }
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais16_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, (int32_t *)SA, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)SA, n, threads);
+            if (freq != NULL) { libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    return libsais16x64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, SA, n, LIBSAIS_FLAGS_NONE, 0, NULL, fs, freq);
+}
+
+int64_t libsais16x64_gsa_ctx(const void * ctx, const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (SA == NULL) || (n < 0) || (n > 0 && T[n - 1] != 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { SA[0] = 0; if (freq != NULL) { freq[T[0]]++; } }
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais16_gsa_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, (int32_t *)SA, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)SA, n, threads);
+            if (freq != NULL) { libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    return libsais16x64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, SA, n, LIBSAIS_FLAGS_GSA, 0, NULL, fs, freq);
+}
+
+int64_t libsais16x64_bwt_ctx(const void * ctx, const uint16_t * T, uint16_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (U == NULL) || (A == NULL) || (n < 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { U[0] = T[0]; if (freq != NULL) { freq[T[0]]++; } }
+        return n;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais16_bwt_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            if (freq != NULL) { libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    sa_sint_t index = libsais16x64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, A, n, LIBSAIS_FLAGS_BWT, 0, NULL, fs, freq);
+    if (index >= 0)
+    {
+        index++;
+
+        U[0] = T[n - 1];
+        libsais16x64_bwt_copy_16u_omp(U + 1, A, index - 1, threads);
+        libsais16x64_bwt_copy_16u_omp(U + index, A + index, n - index, threads);
+    }
+
+    return index;
+}
+
+int64_t libsais16x64_bwt_aux_ctx(const void * ctx, const uint16_t * T, uint16_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I)
+{
+    if ((ctx == NULL) || (T == NULL) || (U == NULL) || (A == NULL) || (n < 0) || (fs < 0) || (r < 2) || ((r & (r - 1)) != 0) || (I == NULL))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { U[0] = T[0]; if (freq != NULL) { freq[T[0]]++; } }
+        I[0] = n;
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX && r <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais16_bwt_aux_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq, (int32_t)r, (int32_t *)I);
+
+        if (index >= 0)
+        {
+            libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)I, 1 + ((n - 1) / r), threads);
+            if (freq != NULL) { libsais16x64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    sa_sint_t index = libsais16x64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, A, n, LIBSAIS_FLAGS_BWT, r, I, fs, freq);
+    if (index == 0)
+    {
+        U[0] = T[n - 1];
+        libsais16x64_bwt_copy_16u_omp(U + 1, A, I[0] - 1, threads);
+        libsais16x64_bwt_copy_16u_omp(U + I[0], A + I[0], n - I[0], threads);
+    }
+
+    return index;
+}
+
 int64_t libsais16x64(const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
 {
     if ((T == NULL) || (SA == NULL) || (n < 0) || (fs < 0))
@@ -7171,6 +7374,14 @@ int64_t libsais16x64_bwt_aux(const uint16_t * T, uint16_t * U, int64_t * A, int6
 
 #if defined(LIBSAIS_OPENMP)
 
+void * libsais16x64_create_ctx_omp(int64_t threads)
+{
+    if (threads < 0) { return NULL; }
+
+    threads = threads > 0 ? threads : omp_get_max_threads();
+    return (void *)libsais16x64_create_ctx_main(threads);
+}
+
 int64_t libsais16x64_omp(const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq, int64_t threads)
 {
     if ((T == NULL) || (SA == NULL) || (n < 0) || (fs < 0) || (threads < 0))
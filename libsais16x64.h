@@ -49,6 +49,29 @@ extern "C" {
 
     #include <stdint.h>
 
+    /**
+    * Creates the libsais16x64 context that allows reusing allocated memory with each libsais16x64 operation.
+    * In multi-threaded environments, use one context per thread for parallel executions.
+    * @return the libsais16x64 context, NULL otherwise.
+    */
+    LIBSAIS16X64_API void * libsais16x64_create_ctx(void);
+
+#if defined(LIBSAIS_OPENMP)
+    /**
+    * Creates the libsais16x64 context that allows reusing allocated memory with each parallel libsais16x64 operation using OpenMP.
+    * In multi-threaded environments, use one context per thread for parallel executions.
+    * @param threads The number of OpenMP threads to use (can be 0 for OpenMP default).
+    * @return the libsais16x64 context, NULL otherwise.
+    */
+    LIBSAIS16X64_API void * libsais16x64_create_ctx_omp(int64_t threads);
+#endif
+
+    /**
+    * Destroys the libsais16x64 context and frees previously allocated memory.
+    * @param ctx The libsais16x64 context (can be NULL).
+    */
+    LIBSAIS16X64_API void libsais16x64_free_ctx(void * ctx);
+
     /**
     * Constructs the suffix array of a given 16-bit string.
     * @param T [0..n-1] The input 16-bit string.
@@ -83,6 +106,30 @@ extern "C" {
     */
     LIBSAIS16X64_API int64_t libsais16x64_long(int64_t * T, int64_t * SA, int64_t n, int64_t k, int64_t fs);
 
+    /**
+    * Constructs the suffix array of a given 16-bit string using libsais16x64 context.
+    * @param ctx The libsais16x64 context.
+    * @param T [0..n-1] The input 16-bit string.
+    * @param SA [0..n-1+fs] The output array of suffixes.
+    * @param n The length of the given 16-bit string.
+    * @param fs The extra space available at the end of SA array (0 should be enough for most cases).
+    * @param freq [0..65535] The output 16-bit symbol frequency table (can be NULL).
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS16X64_API int64_t libsais16x64_ctx(const void * ctx, const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq);
+
+    /**
+    * Constructs the generalized suffix array (GSA) of given 16-bit string set using libsais16x64 context.
+    * @param ctx The libsais16x64 context.
+    * @param T [0..n-1] The input 16-bit string set using 0 as separators (T[n-1] must be 0).
+    * @param SA [0..n-1+fs] The output array of suffixes.
+    * @param n The length of the given 16-bit string set.
+    * @param fs The extra space available at the end of SA array (0 should be enough for most cases).
+    * @param freq [0..65535] The output 16-bit symbol frequency table (can be NULL).
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS16X64_API int64_t libsais16x64_gsa_ctx(const void * ctx, const uint16_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq);
+
 #if defined(LIBSAIS_OPENMP)
     /**
     * Constructs the suffix array of a given 16-bit string in parallel using OpenMP.
@@ -148,6 +195,34 @@ extern "C" {
     */
     LIBSAIS16X64_API int64_t libsais16x64_bwt_aux(const uint16_t * T, uint16_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I);
 
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of a given 16-bit string using libsais16x64 context.
+    * @param ctx The libsais16x64 context.
+    * @param T [0..n-1] The input 16-bit string.
+    * @param U [0..n-1] The output 16-bit string (can be T).
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given 16-bit string.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..65535] The output 16-bit symbol frequency table (can be NULL).
+    * @return The primary index if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS16X64_API int64_t libsais16x64_bwt_ctx(const void * ctx, const uint16_t * T, uint16_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq);
+
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of a given 16-bit string with auxiliary indexes using libsais16x64 context.
+    * @param ctx The libsais16x64 context.
+    * @param T [0..n-1] The input 16-bit string.
+    * @param U [0..n-1] The output 16-bit string (can be T).
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given 16-bit string.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..65535] The output 16-bit symbol frequency table (can be NULL).
+    * @param r The sampling rate for auxiliary indexes (must be power of 2).
+    * @param I [0..(n-1)/r] The output auxiliary indexes.
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS16X64_API int64_t libsais16x64_bwt_aux_ctx(const void * ctx, const uint16_t * T, uint16_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I);
+
 #if defined(LIBSAIS_OPENMP)
     /**
     * Constructs the burrows-wheeler transformed 16-bit string (BWT) of a given 16-bit string in parallel using OpenMP.
@@ -23,6 +23,15 @@ Please see the file LICENSE for full copyright information.
 
 #include "libsais.h"
 #include "libsais64.h"
+#ifdef SA_PROF
+#include "saprof.h"
+#else
+#define SAPROF_DECL(v)
+#define SAPROF_LAP(v, lib, stage, bytes)  ((void)0)
+#define SAPROF_SKIP(v)                    ((void)0)
+#define SAPROF_ENTER()                    ((void)0)
+#define SAPROF_LEAVE(v)                   ((void)0)
+#endif
 
 #include <stddef.h>
 #include <stdint.h>
@@ -89,6 +98,7 @@ typedef struct LIBSAIS_CONTEXT
     sa_sint_t *                         buckets;
     LIBSAIS_THREAD_STATE *              thread_state;
     fast_sint_t                         threads;
+    void *                              ctx32;
 } LIBSAIS_CONTEXT;
 
 typedef struct LIBSAIS_UNBWT_CONTEXT
@@ -235,6 +245,45 @@ static void libsais64_free_thread_state(LIBSAIS_THREAD_STATE * thread_state)
     }
 }
 
+static LIBSAIS_CONTEXT * libsais64_create_ctx_main(sa_sint_t threads)
+{
+    LIBSAIS_CONTEXT *       RESTRICT ctx            = (LIBSAIS_CONTEXT *)libsais64_alloc_aligned(sizeof(LIBSAIS_CONTEXT), 64);
+    sa_sint_t *             RESTRICT buckets        = (sa_sint_t *)libsais64_alloc_aligned((size_t)8 * ALPHABET_SIZE * sizeof(sa_sint_t), 4096);
+    LIBSAIS_THREAD_STATE *  RESTRICT thread_state   = threads > 1 ? libsais64_alloc_thread_state(threads) : NULL;
+#if defined(LIBSAIS_OPENMP)
+    void *                           ctx32          = threads > 1 ? libsais_create_ctx_omp((int32_t)threads) : libsais_create_ctx();
+#else
+    void *                           ctx32          = libsais_create_ctx();
+#endif
+
+    if (ctx != NULL && buckets != NULL && (thread_state != NULL || threads == 1) && ctx32 != NULL)
+    {
+        ctx->buckets = buckets;
+        ctx->threads = threads;
+        ctx->thread_state = thread_state;
+        ctx->ctx32 = ctx32;
+
+        return ctx;
+    }
+
+    libsais_free_ctx(ctx32);
+    libsais64_free_thread_state(thread_state);
+    libsais64_free_aligned(buckets);
+    libsais64_free_aligned(ctx);
+    return NULL;
+}
+
+static void libsais64_free_ctx_main(LIBSAIS_CONTEXT * ctx)
+{
+    if (ctx != NULL)
+    {
+        libsais_free_ctx(ctx->ctx32);
+        libsais64_free_thread_state(ctx->thread_state);
+        libsais64_free_aligned(ctx->buckets);
+        libsais64_free_aligned(ctx);
+    }
+}
+
 #if defined(LIBSAIS_OPENMP)
 
 static sa_sint_t libsais64_count_negative_marked_suffixes(sa_sint_t * RESTRICT SA, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
@@ -6152,9 +6201,249 @@ static void libsais64_clear_lms_suffixes_omp(sa_sint_t * RESTRICT SA, sa_sint_t
     }
 }
 
+static sa_sint_t libsais64_gsa_bwt_string_index(const sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t p)
+{
+    sa_sint_t l = 0, r = m - 1;
+    while (l < r)
+    {
+        sa_sint_t c = l + ((r - l) >> 1);
+        if ((SA[c] & SAINT_MAX) < p) { l = c + 1; } else { r = c; }
+    }
+
+    return l + 1;
+}
+
+static void libsais64_final_gsa_bwt_scan_left_to_right_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, fast_sint_t n, fast_sint_t m, sa_sint_t k, sa_sint_t * RESTRICT induction_bucket, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+    SA[induction_bucket[T[(sa_sint_t)n - 1]]++] = ((sa_sint_t)n - 1) | (sa_sint_t)((sa_uint_t)(T[(sa_sint_t)n - 2] < T[(sa_sint_t)n - 1]) << (SAINT_BIT - 1));
+
+    libsais64_final_sorting_scan_left_to_right_8u(T, SA, induction_bucket, 0, m);
+
+    if (threads == 1 || n < 65536)
+    {
+        libsais64_final_bwt_scan_left_to_right_8u(T, SA, induction_bucket, m, n - m);
+    }
+#if defined(LIBSAIS_OPENMP)
+    else
+    {
+        fast_sint_t block_start;
+        for (block_start = m; block_start < n; )
+        {
+            if (SA[block_start] == 0)
+            {
+                block_start++;
+            }
+            else
+            {
+                fast_sint_t block_max_end = block_start + ((fast_sint_t)threads) * (LIBSAIS_PER_THREAD_CACHE_SIZE - 16 * (fast_sint_t)threads); if (block_max_end > n) { block_max_end = n;}
+                fast_sint_t block_end     = block_start + 1; while (block_end < block_max_end && SA[block_end] != 0) { block_end++; }
+                fast_sint_t block_size    = block_end - block_start;
+
+                if (block_size < 32)
+                {
+                    for (; block_start < block_end; block_start += 1)
+                    {
+                        sa_sint_t p = SA[block_start]; SA[block_start] = p & SAINT_MAX; if (p > 0) { p--; SA[block_start] = T[p] | SAINT_MIN; SA[induction_bucket[T[p]]++] = p | (sa_sint_t)((sa_uint_t)(T[p - (p > 0)] < T[p]) << (SAINT_BIT - 1)); }
+                    }
+                }
+                else
+                {
+                    libsais64_final_bwt_scan_left_to_right_8u_block_omp(T, SA, k, induction_bucket, block_start, block_size, threads, thread_state);
+                    block_start = block_end;
+                }
+            }
+        }
+    }
+#else
+    UNUSED(k); UNUSED(thread_state);
+#endif
+}
+
+static void libsais64_final_gsa_bwt_scan_right_to_left_8u(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT induction_bucket, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
+{
+    const fast_sint_t prefetch_distance = 32;
+
+    fast_sint_t i, j;
+    for (i = omp_block_start + omp_block_size - 1, j = omp_block_start + prefetch_distance + 1; i >= j; i -= 2)
+    {
+        libsais64_prefetchw(&SA[i - 2 * prefetch_distance]);
+
+        sa_sint_t s0 = SA[i - prefetch_distance - 0]; const uint8_t * Ts0 = &T[s0] - 1; libsais64_prefetchr(s0 > 0 ? Ts0 : NULL); Ts0--; libsais64_prefetchr(s0 > 0 ? Ts0 : NULL);
+        sa_sint_t s1 = SA[i - prefetch_distance - 1]; const uint8_t * Ts1 = &T[s1] - 1; libsais64_prefetchr(s1 > 0 ? Ts1 : NULL); Ts1--; libsais64_prefetchr(s1 > 0 ? Ts1 : NULL);
+
+        sa_sint_t p0 = SA[i - 0]; if (p0 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 0); }
+        SA[i - 0] = p0 & SAINT_MAX; if (p0 > 0) { p0--; uint8_t c0 = T[p0 - (p0 > 0)], c1 = T[p0]; SA[i - 0] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p0 : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p0)] = (sa_sint_t)(i - 0); } }
+
+        sa_sint_t p1 = SA[i - 1]; if (p1 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 1); }
+        SA[i - 1] = p1 & SAINT_MAX; if (p1 > 0) { p1--; uint8_t c0 = T[p1 - (p1 > 0)], c1 = T[p1]; SA[i - 1] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p1 : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p1)] = (sa_sint_t)(i - 1); } }
+    }
+
+    for (j -= prefetch_distance + 1; i >= j; i -= 1)
+    {
+        sa_sint_t p = SA[i]; if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+        SA[i] = p & SAINT_MAX; if (p > 0) { p--; uint8_t c0 = T[p - (p > 0)], c1 = T[p]; SA[i] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; SA[--induction_bucket[c1]] = (c0 <= c1) ? p : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p)] = (sa_sint_t)i; } }
+    }
+}
+
+#if defined(LIBSAIS_OPENMP)
+
+static fast_sint_t libsais64_final_gsa_bwt_scan_right_to_left_8u_block_prepare(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t k, sa_sint_t * RESTRICT buckets, LIBSAIS_THREAD_CACHE * RESTRICT cache, fast_sint_t omp_block_start, fast_sint_t omp_block_size)
+{
+   const fast_sint_t prefetch_distance = 32;
+
+   memset(buckets, 0, (size_t)k * sizeof(sa_sint_t));
+
+   fast_sint_t i, j, count = 0;
+   for (i = omp_block_start + omp_block_size - 1, j = omp_block_start + prefetch_distance + 1; i >= j; i -= 2)
+   {
+       libsais64_prefetchw(&SA[i - 2 * prefetch_distance]);
+
+       sa_sint_t s0 = SA[i - prefetch_distance - 0]; const uint8_t * Ts0 = &T[s0] - 1; libsais64_prefetchr(s0 > 0 ? Ts0 : NULL); Ts0--; libsais64_prefetchr(s0 > 0 ? Ts0 : NULL);
+       sa_sint_t s1 = SA[i - prefetch_distance - 1]; const uint8_t * Ts1 = &T[s1] - 1; libsais64_prefetchr(s1 > 0 ? Ts1 : NULL); Ts1--; libsais64_prefetchr(s1 > 0 ? Ts1 : NULL);
+
+       sa_sint_t p0 = SA[i - 0]; if (p0 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 0); }
+       SA[i - 0] = p0 & SAINT_MAX; if (p0 > 0) { p0--; uint8_t c0 = T[p0 - (p0 > 0)], c1 = T[p0]; SA[i - 0] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p0 : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p0)] = (sa_sint_t)(i - 0); } }
+
+       sa_sint_t p1 = SA[i - 1]; if (p1 == 0 && I != NULL) { I[0] = (sa_sint_t)(i - 1); }
+       SA[i - 1] = p1 & SAINT_MAX; if (p1 > 0) { p1--; uint8_t c0 = T[p1 - (p1 > 0)], c1 = T[p1]; SA[i - 1] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p1 : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p1)] = (sa_sint_t)(i - 1); } }
+   }
+
+   for (j -= prefetch_distance + 1; i >= j; i -= 1)
+   {
+       sa_sint_t p = SA[i]; if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+       SA[i] = p & SAINT_MAX; if (p > 0) { p--; uint8_t c0 = T[p - (p > 0)], c1 = T[p]; SA[i] = c1; if (c1 > 0) { sa_sint_t t = c0 | SAINT_MIN; buckets[cache[count].symbol = c1]++; cache[count++].index = (c0 <= c1) ? p : t; } else if (I != NULL) { I[libsais64_gsa_bwt_string_index(SA, m, p)] = (sa_sint_t)i; } }
+   }
+
+   return count;
+}
+
+static void libsais64_final_gsa_bwt_scan_right_to_left_8u_block_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t k, sa_sint_t * RESTRICT induction_bucket, fast_sint_t block_start, fast_sint_t block_size, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+#if defined(LIBSAIS_OPENMP)
+    #pragma omp parallel num_threads(threads) if(threads > 1 && block_size >= 64 * (k > 256 ? k : 256) && omp_get_dynamic() == 0)
+#endif
+    {
+#if defined(LIBSAIS_OPENMP)
+        fast_sint_t omp_thread_num    = omp_get_thread_num();
+        fast_sint_t omp_num_threads   = omp_get_num_threads();
+#else
+        UNUSED(k); UNUSED(threads); UNUSED(thread_state);
+
+        fast_sint_t omp_thread_num    = 0;
+        fast_sint_t omp_num_threads   = 1;
+#endif
+        fast_sint_t omp_block_stride  = (block_size / omp_num_threads) & (-16);
+        fast_sint_t omp_block_start   = omp_thread_num * omp_block_stride;
+        fast_sint_t omp_block_size    = omp_thread_num < omp_num_threads - 1 ? omp_block_stride : block_size - omp_block_start;
+
+        omp_block_start += block_start;
+
+        if (omp_num_threads == 1)
+        {
+            libsais64_final_gsa_bwt_scan_right_to_left_8u(T, SA, m, I, induction_bucket, omp_block_start, omp_block_size);
+        }
+#if defined(LIBSAIS_OPENMP)
+        else
+        {
+            {
+                thread_state[omp_thread_num].state.count = libsais64_final_gsa_bwt_scan_right_to_left_8u_block_prepare(T, SA, m, I, k, thread_state[omp_thread_num].state.buckets, thread_state[omp_thread_num].state.cache, omp_block_start, omp_block_size);
+            }
+
+            #pragma omp barrier
+
+            #pragma omp master
+            {
+                fast_sint_t t;
+                for (t = omp_num_threads - 1; t >= 0; --t)
+                {
+                    sa_sint_t * RESTRICT temp_bucket = thread_state[t].state.buckets;
+                    fast_sint_t c; for (c = 0; c < k; c += 1) { sa_sint_t A = induction_bucket[c], B = temp_bucket[c]; induction_bucket[c] = A - B; temp_bucket[c] = A; }
+                }
+            }
+
+            #pragma omp barrier
+
+            {
+                libsais64_final_order_scan_right_to_left_8u_block_place(SA, thread_state[omp_thread_num].state.buckets, thread_state[omp_thread_num].state.cache, thread_state[omp_thread_num].state.count);
+            }
+        }
+#endif
+    }
+}
+
+#endif
+
+static void libsais64_final_gsa_bwt_scan_right_to_left_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, fast_sint_t n, fast_sint_t m, sa_sint_t k, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT induction_bucket, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
+{
+    if (threads == 1 || n - m < 65536)
+    {
+        libsais64_final_gsa_bwt_scan_right_to_left_8u(T, SA, (sa_sint_t)m, I, induction_bucket, m, n - m);
+    }
+#if defined(LIBSAIS_OPENMP)
+    else
+    {
+        fast_sint_t block_start;
+        for (block_start = n - 1; block_start >= m; )
+        {
+            if (SA[block_start] == 0)
+            {
+                if (I != NULL) { I[0] = (sa_sint_t)block_start; }
+                block_start--;
+            }
+            else
+            {
+                fast_sint_t block_max_end = block_start - ((fast_sint_t)threads) * (LIBSAIS_PER_THREAD_CACHE_SIZE - 16 * (fast_sint_t)threads); if (block_max_end < m) { block_max_end = m - 1; }
+                fast_sint_t block_end     = block_start - 1; while (block_end > block_max_end && SA[block_end] != 0) { block_end--; }
+                fast_sint_t block_size    = block_start - block_end;
+
+                if (block_size < 32)
+                {
+                    libsais64_final_gsa_bwt_scan_right_to_left_8u(T, SA, (sa_sint_t)m, I, induction_bucket, block_end + 1, block_size);
+                    block_start = block_end;
+                }
+                else
+                {
+                    libsais64_final_gsa_bwt_scan_right_to_left_8u_block_omp(T, SA, (sa_sint_t)m, I, k, induction_bucket, block_end + 1, block_size, threads, thread_state);
+                    block_start = block_end;
+                }
+            }
+        }
+    }
+#else
+    UNUSED(k); UNUSED(thread_state);
+#endif
+}
+
+static void libsais64_final_gsa_bwt_store_sentinels_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t m, sa_sint_t * RESTRICT I, sa_sint_t threads)
+{
+    fast_sint_t i;
+
+#if defined(LIBSAIS_OPENMP)
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1 && m >= 65536)
+#else
+    UNUSED(threads);
+#endif
+    for (i = 0; i < m; ++i)
+    {
+        sa_sint_t p = SA[i] & SAINT_MAX; SA[i] = p > 0 ? T[p - 1] : 0;
+        if (p == 0 && I != NULL) { I[0] = (sa_sint_t)i; }
+    }
+}
+
 static sa_sint_t libsais64_induce_final_order_8u_omp(const uint8_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t n, sa_sint_t k, sa_sint_t flags, sa_sint_t r, sa_sint_t * RESTRICT I, sa_sint_t * RESTRICT buckets, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
 {
-    if ((flags & LIBSAIS_FLAGS_BWT) == 0)
+    if ((flags & LIBSAIS_FLAGS_BWT) && (flags & LIBSAIS_FLAGS_GSA))
+    {
+        sa_sint_t m = buckets[7 * ALPHABET_SIZE]; buckets[6 * ALPHABET_SIZE] = m - 1;
+
+        libsais64_final_gsa_bwt_scan_left_to_right_8u_omp(T, SA, n, m, k, &buckets[6 * ALPHABET_SIZE], threads, thread_state);
+        if (threads > 1 && n >= 65536) { libsais64_clear_lms_suffixes_omp(SA, n, ALPHABET_SIZE, &buckets[6 * ALPHABET_SIZE], &buckets[7 * ALPHABET_SIZE], threads); }
+        libsais64_final_gsa_bwt_scan_right_to_left_8u_omp(T, SA, n, m, k, I, &buckets[7 * ALPHABET_SIZE], threads, thread_state);
+        libsais64_final_gsa_bwt_store_sentinels_omp(T, SA, m, I, threads);
+
+        return m;
+    }
+    else if ((flags & LIBSAIS_FLAGS_BWT) == 0)
     {
         if (flags & LIBSAIS_FLAGS_GSA) { buckets[6 * ALPHABET_SIZE] = buckets[7 * ALPHABET_SIZE] - 1; }
 
@@ -6685,6 +6974,8 @@ static void libsais64_convert_inplace_32u_to_64u_omp(uint32_t * V, sa_sint_t n,
 
 static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t * RESTRICT SA, sa_sint_t n, sa_sint_t k, sa_sint_t fs, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state, sa_sint_t * RESTRICT local_buffer)
 {
+    SAPROF_DECL(prof);
+
     fs = fs < (SAINT_MAX - n) ? fs : (SAINT_MAX - n);
 
     if (n <= INT32_MAX)
@@ -6693,17 +6984,20 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
         if ((new_fs / k >= 6) || (new_fs / k >= 4 && n <= INT32_MAX / 2) || (new_fs / k < 4 && new_fs >= fs))
         {
             libsais64_convert_inplace_64u_to_32u((uint32_t *)(void *)T, 0, n);
+            SAPROF_LAP(prof, "libsais64", "to 32-bit", (int64_t)n * 12);
 
 #if defined(LIBSAIS_OPENMP)
             sa_sint_t index = libsais_int_omp((int32_t *)T, (int32_t *)SA, (int32_t)n, (int32_t)k, (int32_t)new_fs, (int32_t)threads);
 #else
             sa_sint_t index = libsais_int((int32_t *)T, (int32_t *)SA, (int32_t)n, (int32_t)k, (int32_t)new_fs);
 #endif
+            SAPROF_SKIP(prof); // timed by libsais
             if (index >= 0)
             {
                 libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)SA, n, threads);
                 libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)T, n, threads);
             }
+            SAPROF_LAP(prof, "libsais64", "to 64-bit", (int64_t)n * 24);
 
             return index;
         }
@@ -6730,10 +7024,12 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
 
             libsais64_initialize_buckets_for_partial_sorting_32s_6k(T, k, buckets, first_lms_suffix, left_suffixes_count);
             libsais64_induce_partial_order_32s_6k_omp(T, SA, n, k, buckets, first_lms_suffix, left_suffixes_count, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = (n / 8192) < k
                 ? libsais64_renumber_and_mark_distinct_lms_suffixes_32s_4k_omp(SA, n, m, threads, thread_state)
                 : libsais64_renumber_and_gather_lms_suffixes_omp(SA, n, m, fs, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
 
             if (names < m)
             {
@@ -6741,12 +7037,16 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
                     ? libsais64_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state)
                     : 0;
 
+                SAPROF_LAP(prof, "libsais64", "reduce", (n / 8192) < k ? (int64_t)n * sizeof(sa_sint_t) : 0);
+                SAPROF_ENTER();
                 if (libsais64_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais64_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais64", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6756,6 +7056,7 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
             libsais64_initialize_buckets_start_and_end_32s_4k(k, buckets);
             libsais64_place_lms_suffixes_histogram_32s_4k(SA, n, k, m, buckets);
             libsais64_induce_final_order_32s_4k(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         }
         else
         {
@@ -6764,6 +7065,7 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
             libsais64_initialize_buckets_start_and_end_32s_6k(k, buckets);
             libsais64_place_lms_suffixes_histogram_32s_6k(SA, n, k, m, buckets);
             libsais64_induce_final_order_32s_6k(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         }
 
         return 0;
@@ -6784,18 +7086,24 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
             
             libsais64_place_lms_suffixes_interval_32s_4k(SA, n, k, m - 1, buckets);
             libsais64_induce_partial_order_32s_4k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais64_renumber_and_mark_distinct_lms_suffixes_32s_4k_omp(SA, n, m, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 sa_sint_t f = libsais64_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais64", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais64_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais64_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais64", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6810,6 +7118,7 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
         libsais64_initialize_buckets_start_and_end_32s_4k(k, buckets);
         libsais64_place_lms_suffixes_histogram_32s_4k(SA, n, k, m, buckets);
         libsais64_induce_final_order_32s_4k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
 
         return 0;
     }
@@ -6829,18 +7138,24 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
 
             libsais64_initialize_buckets_start_and_end_32s_2k(k, buckets);
             libsais64_induce_partial_order_32s_2k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais64_renumber_and_mark_distinct_lms_suffixes_32s_1k_omp(T, SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais64", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 sa_sint_t f = libsais64_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais64", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais64_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais64_reconstruct_compacted_lms_suffixes_32s_2k_omp(T, SA, n, k, m, fs, f, buckets, threads, thread_state);
+                SAPROF_LAP(prof, "libsais64", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
             }
             else
             {
@@ -6857,6 +7172,7 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
 
         libsais64_initialize_buckets_start_and_end_32s_2k(k, buckets);
         libsais64_induce_final_order_32s_2k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
 
         return 0;
     }
@@ -6878,20 +7194,26 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
         if (m > 1)
         {
             libsais64_induce_partial_order_32s_1k_omp(T, SA, n, k, buckets, threads, thread_state);
+            SAPROF_LAP(prof, "libsais64", "sort LMS", (int64_t)n * 5 * sizeof(sa_sint_t));
 
             sa_sint_t names = libsais64_renumber_and_mark_distinct_lms_suffixes_32s_1k_omp(T, SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais64", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
             if (names < m)
             {
                 if (buffer != NULL) { libsais64_free_aligned(buffer); buckets = NULL; }
 
                 sa_sint_t f = libsais64_compact_lms_suffixes_32s_omp(T, SA, n, m, fs, threads, thread_state);
 
+                SAPROF_LAP(prof, "libsais64", "reduce", (int64_t)n * sizeof(sa_sint_t));
+                SAPROF_ENTER();
                 if (libsais64_main_32s_recursion(SA + n + fs - m + f, SA, m - f, names - f, fs + n - 2 * m + f, threads, thread_state, local_buffer) != 0)
                 {
                     return -2;
                 }
+                SAPROF_LEAVE(prof);
 
                 libsais64_reconstruct_compacted_lms_suffixes_32s_1k_omp(T, SA, n, m, fs, f, threads, thread_state);
+                SAPROF_LAP(prof, "libsais64", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
 
                 if (buckets == NULL) { buckets = buffer = (sa_sint_t *)libsais64_alloc_aligned((size_t)k * sizeof(sa_sint_t), 4096); }
                 if (buckets == NULL) { return -2; }
@@ -6903,6 +7225,7 @@ static sa_sint_t libsais64_main_32s_recursion(sa_sint_t * RESTRICT T, sa_sint_t
         }
 
         libsais64_induce_final_order_32s_1k(T, SA, n, k, buckets, threads, thread_state);
+        SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * 4 * sizeof(sa_sint_t));
         libsais64_free_aligned(buffer);
 
         return 0;
@@ -6918,6 +7241,8 @@ static sa_sint_t libsais64_main_32s_entry(sa_sint_t * RESTRICT T, sa_sint_t * RE
 
 static sa_sint_t libsais64_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t * RESTRICT buckets, sa_sint_t flags, sa_sint_t r, sa_sint_t * RESTRICT I, sa_sint_t fs, sa_sint_t * freq, sa_sint_t threads, LIBSAIS_THREAD_STATE * RESTRICT thread_state)
 {
+    SAPROF_DECL(prof);
+
     fs = fs < (SAINT_MAX - n) ? fs : (SAINT_MAX - n);
 
     sa_sint_t m = libsais64_count_and_gather_lms_suffixes_8u_omp(T, SA, n, buckets, threads, thread_state);
@@ -6939,17 +7264,22 @@ static sa_sint_t libsais64_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t
 
         libsais64_initialize_buckets_for_partial_sorting_8u(T, buckets, first_lms_suffix, left_suffixes_count);
         libsais64_induce_partial_order_8u_omp(T, SA, n, k, flags, buckets, first_lms_suffix, left_suffixes_count, threads, thread_state);
+        SAPROF_LAP(prof, "libsais64", "sort LMS", (int64_t)n * (3 + 2 * sizeof(sa_sint_t)));
 
         sa_sint_t names = libsais64_renumber_and_gather_lms_suffixes_omp(SA, n, m, fs, threads, thread_state);
+        SAPROF_LAP(prof, "libsais64", "name LMS", ((int64_t)n + m) * sizeof(sa_sint_t));
         if (names < m)
         {
+            SAPROF_ENTER();
             if (libsais64_main_32s_entry(SA + n + fs - m, SA, m, names, fs + n - 2 * m, threads, thread_state) != 0)
             {
                 return -2;
             }
+            SAPROF_LEAVE(prof);
 
             libsais64_gather_lms_suffixes_8u_omp(T, SA, n, threads, thread_state);
             libsais64_reconstruct_lms_suffixes_omp(SA, n, m, threads);
+            SAPROF_LAP(prof, "libsais64", "reconstruct", ((int64_t)n + 2 * m) * sizeof(sa_sint_t));
         }
 
         libsais64_place_lms_suffixes_interval_8u(SA, n, m, flags, buckets);
@@ -6959,7 +7289,10 @@ static sa_sint_t libsais64_main_8u(const uint8_t * T, sa_sint_t * SA, sa_sint_t
         memset(SA, 0, (size_t)n * sizeof(sa_sint_t));
     }
 
-    return libsais64_induce_final_order_8u_omp(T, SA, n, k, flags, r, I, buckets, threads, thread_state);
+    sa_sint_t index = libsais64_induce_final_order_8u_omp(T, SA, n, k, flags, r, I, buckets, threads, thread_state);
+    SAPROF_LAP(prof, "libsais64", "induce final", (int64_t)n * (2 + 2 * sizeof(sa_sint_t)));
+
+    return index;
 }
 
 static sa_sint_t libsais64_main(const uint8_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t flags, sa_sint_t r, sa_sint_t * I, sa_sint_t fs, sa_sint_t * freq, sa_sint_t threads)
@@ -6977,6 +7310,13 @@ static sa_sint_t libsais64_main(const uint8_t * T, sa_sint_t * SA, sa_sint_t n,
     return index;
 }
 
+static sa_sint_t libsais64_main_ctx(const LIBSAIS_CONTEXT * ctx, const uint8_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t flags, sa_sint_t r, sa_sint_t * I, sa_sint_t fs, sa_sint_t * freq)
+{
+    return ctx != NULL && (ctx->buckets != NULL && (ctx->thread_state != NULL || ctx->threads == 1))
+        ? libsais64_main_8u(T, SA, n, ctx->buckets, flags, r, I, fs, freq, (sa_sint_t)ctx->threads, ctx->thread_state)
+        : -2;
+}
+
 static sa_sint_t libsais64_main_long(sa_sint_t * T, sa_sint_t * SA, sa_sint_t n, sa_sint_t k, sa_sint_t fs, sa_sint_t threads)
 {
     LIBSAIS_THREAD_STATE * RESTRICT thread_state = threads > 1 ? libsais64_alloc_thread_state(threads) : NULL;
@@ -7038,6 +7378,173 @@ static void libsais64_bwt_copy_8u_omp(uint8_t * RESTRICT U, sa_sint_t * RESTRICT
     }
 }
 
+void * libsais64_create_ctx(void)
+{
+    return (void *)libsais64_create_ctx_main(1);
+}
+
+void libsais64_free_ctx(void * ctx)
+{
+    libsais64_free_ctx_main((LIBSAIS_CONTEXT *)ctx);
+}
+
+int64_t libsais64_ctx(const void * ctx, const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (SA == NULL) || (n < 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { SA[0] = 0; if (freq != NULL) { freq[T[0]]++; } }
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, (int32_t *)SA, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)SA, n, threads);
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    return libsais64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, SA, n, LIBSAIS_FLAGS_NONE, 0, NULL, fs, freq);
+}
+
+int64_t libsais64_gsa_ctx(const void * ctx, const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (SA == NULL) || (n < 0) || (n > 0 && T[n - 1] != 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { SA[0] = 0; if (freq != NULL) { freq[T[0]]++; } }
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_gsa_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, (int32_t *)SA, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)SA, n, threads);
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    return libsais64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, SA, n, LIBSAIS_FLAGS_GSA, 0, NULL, fs, freq);
+}
+
+int64_t libsais64_bwt_ctx(const void * ctx, const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq)
+{
+    if ((ctx == NULL) || (T == NULL) || (U == NULL) || (A == NULL) || (n < 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { U[0] = T[0]; if (freq != NULL) { freq[T[0]]++; } }
+        return n;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_bwt_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq);
+
+        if (index >= 0)
+        {
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    sa_sint_t index = libsais64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, A, n, LIBSAIS_FLAGS_BWT, 0, NULL, fs, freq);
+    if (index >= 0)
+    {
+        index++;
+
+        U[0] = T[n - 1];
+        libsais64_bwt_copy_8u_omp(U + 1, A, index - 1, threads);
+        libsais64_bwt_copy_8u_omp(U + index, A + index, n - index, threads);
+    }
+
+    return index;
+}
+
+int64_t libsais64_bwt_aux_ctx(const void * ctx, const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I)
+{
+    if ((ctx == NULL) || (T == NULL) || (U == NULL) || (A == NULL) || (n < 0) || (fs < 0) || (r < 2) || ((r & (r - 1)) != 0) || (I == NULL))
+    {
+        return -1;
+    }
+    else if (n <= 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); }
+        if (n == 1) { U[0] = T[0]; if (freq != NULL) { freq[T[0]]++; } }
+        I[0] = n;
+        return 0;
+    }
+
+    sa_sint_t threads = (sa_sint_t)((const LIBSAIS_CONTEXT *)ctx)->threads;
+
+    if (n <= INT32_MAX && r <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_bwt_aux_ctx(((const LIBSAIS_CONTEXT *)ctx)->ctx32, T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq, (int32_t)r, (int32_t *)I);
+
+        if (index >= 0)
+        {
+            libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)I, 1 + ((n - 1) / r), threads);
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    sa_sint_t index = libsais64_main_ctx((const LIBSAIS_CONTEXT *)ctx, T, A, n, LIBSAIS_FLAGS_BWT, r, I, fs, freq);
+    if (index == 0)
+    {
+        U[0] = T[n - 1];
+        libsais64_bwt_copy_8u_omp(U + 1, A, I[0] - 1, threads);
+        libsais64_bwt_copy_8u_omp(U + I[0], A + I[0], n - I[0], threads);
+    }
+
+    return index;
+}
+
+static sa_sint_t libsais64_gsa_bwt_main(const uint8_t * T, uint8_t * U, sa_sint_t * A, sa_sint_t n, sa_sint_t fs, sa_sint_t * freq, sa_sint_t * I, sa_sint_t threads)
+{
+    sa_sint_t m = libsais64_main(T, A, n, LIBSAIS_FLAGS_BWT | LIBSAIS_FLAGS_GSA, 0, I, fs, freq, threads);
+    if (m >= 0)
+    {
+        libsais64_bwt_copy_8u_omp(U, A, n, threads);
+    }
+
+    return m;
+}
+
 int64_t libsais64(const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq)
 {
     if ((T == NULL) || (SA == NULL) || (n < 0) || (fs < 0))
@@ -7191,8 +7698,47 @@ int64_t libsais64_bwt_aux(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n
     return index;
 }
 
+int64_t libsais64_gsa_bwt(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t * I)
+{
+    if ((T == NULL) || (U == NULL) || (A == NULL) || (n <= 0) || (T[n - 1] != 0) || (fs < 0))
+    {
+        return -1;
+    }
+    else if (n == 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); freq[0] = 1; }
+        if (I != NULL) { I[0] = 0; }
+        U[0] = 0;
+        return 1;
+    }
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_gsa_bwt(T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq, (int32_t *)I);
+
+        if (index >= 0)
+        {
+            if (I != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)I, index, 1); }
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, 1); }
+        }
+
+        return index;
+    }
+
+    return libsais64_gsa_bwt_main(T, U, A, n, fs, freq, I, 1);
+}
+
 #if defined(LIBSAIS_OPENMP)
 
+void * libsais64_create_ctx_omp(int64_t threads)
+{
+    if (threads < 0) { return NULL; }
+
+    threads = threads > 0 ? threads : omp_get_max_threads();
+    return (void *)libsais64_create_ctx_main(threads);
+}
+
 int64_t libsais64_omp(const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq, int64_t threads)
 {
     if ((T == NULL) || (SA == NULL) || (n < 0) || (fs < 0) || (threads < 0))
@@ -7356,6 +7902,39 @@ int64_t libsais64_bwt_aux_omp(const uint8_t * T, uint8_t * U, int64_t * A, int64
     return index;
 }
 
+int64_t libsais64_gsa_bwt_omp(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t * I, int64_t threads)
+{
+    if ((T == NULL) || (U == NULL) || (A == NULL) || (n <= 0) || (T[n - 1] != 0) || (fs < 0) || (threads < 0))
+    {
+        return -1;
+    }
+    else if (n == 1)
+    {
+        if (freq != NULL) { memset(freq, 0, ALPHABET_SIZE * sizeof(int64_t)); freq[0] = 1; }
+        if (I != NULL) { I[0] = 0; }
+        U[0] = 0;
+        return 1;
+    }
+
+    threads = threads > 0 ? threads : omp_get_max_threads();
+
+    if (n <= INT32_MAX)
+    {
+        sa_sint_t new_fs = (fs + fs + n + n) <= INT32_MAX ? (fs + fs + n) : INT32_MAX - n;
+        sa_sint_t index = libsais_gsa_bwt_omp(T, U, (int32_t *)A, (int32_t)n, (int32_t)new_fs, (int32_t *)freq, (int32_t *)I, (int32_t)threads);
+
+        if (index >= 0)
+        {
+            if (I != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)I, index, threads); }
+            if (freq != NULL) { libsais64_convert_inplace_32u_to_64u_omp((uint32_t *)freq, ALPHABET_SIZE, threads); }
+        }
+
+        return index;
+    }
+
+    return libsais64_gsa_bwt_main(T, U, A, n, fs, freq, I, threads);
+}
+
 #endif
 
 static void libsais64_unbwt_compute_histogram(const uint8_t * RESTRICT T, fast_sint_t n, sa_uint_t * RESTRICT count)
@@ -49,6 +49,29 @@ extern "C" {
 
     #include <stdint.h>
 
+    /**
+    * Creates the libsais64 context that allows reusing allocated memory with each libsais64 operation.
+    * In multi-threaded environments, use one context per thread for parallel executions.
+    * @return the libsais64 context, NULL otherwise.
+    */
+    LIBSAIS64_API void * libsais64_create_ctx(void);
+
+#if defined(LIBSAIS_OPENMP)
+    /**
+    * Creates the libsais64 context that allows reusing allocated memory with each parallel libsais64 operation using OpenMP.
+    * In multi-threaded environments, use one context per thread for parallel executions.
+    * @param threads The number of OpenMP threads to use (can be 0 for OpenMP default).
+    * @return the libsais64 context, NULL otherwise.
+    */
+    LIBSAIS64_API void * libsais64_create_ctx_omp(int64_t threads);
+#endif
+
+    /**
+    * Destroys the libsais64 context and frees previously allocated memory.
+    * @param ctx The libsais64 context (can be NULL).
+    */
+    LIBSAIS64_API void libsais64_free_ctx(void * ctx);
+
     /**
     * Constructs the suffix array of a given string.
     * @param T [0..n-1] The input string.
@@ -83,6 +106,30 @@ extern "C" {
     */
     LIBSAIS64_API int64_t libsais64_long(int64_t * T, int64_t * SA, int64_t n, int64_t k, int64_t fs);
 
+    /**
+    * Constructs the suffix array of a given string using libsais64 context.
+    * @param ctx The libsais64 context.
+    * @param T [0..n-1] The input string.
+    * @param SA [0..n-1+fs] The output array of suffixes.
+    * @param n The length of the given string.
+    * @param fs The extra space available at the end of SA array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_ctx(const void * ctx, const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq);
+
+    /**
+    * Constructs the generalized suffix array (GSA) of given string set using libsais64 context.
+    * @param ctx The libsais64 context.
+    * @param T [0..n-1] The input string set using 0 as separators (T[n-1] must be 0).
+    * @param SA [0..n-1+fs] The output array of suffixes.
+    * @param n The length of the given string set.
+    * @param fs The extra space available at the end of SA array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_gsa_ctx(const void * ctx, const uint8_t * T, int64_t * SA, int64_t n, int64_t fs, int64_t * freq);
+
 #if defined(LIBSAIS_OPENMP)
     /**
     * Constructs the suffix array of a given string in parallel using OpenMP.
@@ -148,6 +195,47 @@ extern "C" {
     */
     LIBSAIS64_API int64_t libsais64_bwt_aux(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I);
 
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of a given string using libsais64 context.
+    * @param ctx The libsais64 context.
+    * @param T [0..n-1] The input string.
+    * @param U [0..n-1] The output string (can be T).
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @return The primary index if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_bwt_ctx(const void * ctx, const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq);
+
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of a given string with auxiliary indexes using libsais64 context.
+    * @param ctx The libsais64 context.
+    * @param T [0..n-1] The input string.
+    * @param U [0..n-1] The output string (can be T).
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @param r The sampling rate for auxiliary indexes (must be power of 2).
+    * @param I [0..(n-1)/r] The output auxiliary indexes.
+    * @return 0 if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_bwt_aux_ctx(const void * ctx, const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I);
+
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of given string set.
+    * @param T [0..n-1] The input string set using 0 as separators (T[n-1] must be 0).
+    * @param U [0..n-1] The output string (can be T). Each separator is kept as 0; U[i] is 0 if the i-th suffix is the start of a string.
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string set.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @param I [0..m-1] The output index of the BWT row starting with each of the m strings (can be NULL).
+    * @return The number of strings m if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_gsa_bwt(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t * I);
+
 #if defined(LIBSAIS_OPENMP)
     /**
     * Constructs the burrows-wheeler transformed string (BWT) of a given string in parallel using OpenMP.
@@ -176,6 +264,20 @@ extern "C" {
     * @return 0 if no error occurred, -1 or -2 otherwise.
     */
     LIBSAIS64_API int64_t libsais64_bwt_aux_omp(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t r, int64_t * I, int64_t threads);
+
+    /**
+    * Constructs the burrows-wheeler transformed string (BWT) of given string set in parallel using OpenMP.
+    * @param T [0..n-1] The input string set using 0 as separators (T[n-1] must be 0).
+    * @param U [0..n-1] The output string (can be T). Each separator is kept as 0; U[i] is 0 if the i-th suffix is the start of a string.
+    * @param A [0..n-1+fs] The temporary array.
+    * @param n The length of the given string set.
+    * @param fs The extra space available at the end of A array (0 should be enough for most cases).
+    * @param freq [0..255] The output symbol frequency table (can be NULL).
+    * @param I [0..m-1] The output index of the BWT row starting with each of the m strings (can be NULL).
+    * @param threads The number of OpenMP threads to use (can be 0 for OpenMP default).
+    * @return The number of strings m if no error occurred, -1 or -2 otherwise.
+    */
+    LIBSAIS64_API int64_t libsais64_gsa_bwt_omp(const uint8_t * T, uint8_t * U, int64_t * A, int64_t n, int64_t fs, int64_t * freq, int64_t * I, int64_t threads);
 #endif
 
     /**
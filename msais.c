@@ -28,30 +28,209 @@
  * modified from an early version of sais-lite written by Yuta Mori in 2008. */
 
 #include <stdlib.h>
+#include <string.h>
 #include "msais.h"
+#ifdef SA_PROF
+#include "saprof.h"
+#else
+#define SAPROF_DECL(v)
+#define SAPROF_LAP(v, lib, stage, bytes)  ((void)0)
+#define SAPROF_SKIP(v)                    ((void)0)
+#define SAPROF_ENTER()                    ((void)0)
+#define SAPROF_LEAVE(v)                   ((void)0)
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if (defined(_KSA64) || defined(MSAIS64)) && !defined(KSA_CORE32)
+/* The 64-bit build solves reduced problems that fit in 32 bits with the 32-bit
+ * core; see sais_reduced32(). The core is compiled into this object from this
+ * file, with its static functions renamed, so msais64.o stands on its own. */
+#define KSA_CORE32
+#undef _KSA64
+#undef MSAIS64
+#define saint_t saint32_t
+#define ksa_cache_t ksa_cache_t_32
+#define ksa_bwt_t ksa_bwt_t_32
+#define bwt_set_I bwt_set_I_32
+#define cache_len cache_len_32
+#define clearSA clearSA_32
+#define gatherL gatherL_32
+#define gatherS gatherS_32
+#define getBuckets getBuckets_32
+#define getCB getCB_32
+#define getCounts getCounts_32
+#define induce induce_32
+#define induce3 induce3_32
+#define induce8 induce8_32
+#define induceBWT induceBWT_32
+#define induceI induceI_32
+#define induceSA induceSA_32
+#define induceSA_blk induceSA_blk_32
+#define induce_cs induce_cs_32
+#define sais_core sais_core_32
+#define sais_core_cs sais_core_cs_32
+#include "msais.c"
+#undef saint_t
+#undef ksa_cache_t
+#undef ksa_bwt_t
+#undef bwt_set_I
+#undef cache_len
+#undef clearSA
+#undef gatherL
+#undef gatherS
+#undef getBuckets
+#undef getCB
+#undef getCounts
+#undef induce
+#undef induce3
+#undef induce8
+#undef induceBWT
+#undef induceI
+#undef induceSA
+#undef induceSA_blk
+#undef induce_cs
+#undef sais_core
+#undef sais_core_cs
+#undef SAINT_MAX
+#undef SAIS_LIB
+#undef KSA_CORE32
+#define _KSA64 1
+#endif
 
 #if defined(_KSA64) || defined(MSAIS64)
 typedef int64_t saint_t;
 #define SAINT_MAX INT64_MAX
+#define SAIS_LIB "msais64"
 #define SAIS_MAIN ksa_sa64
+#define SAIS_MAIN_OMP ksa_sa64_omp
+#define SAIS_BWT ksa_bwt64
+#define SAIS_LCP ksa_sa_lcp64
+#define SAIS_DA ksa_da64
+#define SAIS_CTX ksa_sa64_ctx
+#define SAIS_CTX_CREATE ksa_ctx_create64
+#define SAIS_CTX_DESTROY ksa_ctx_destroy64
+#define SAIS_EXTRA ksa_extra_bytes64
+#define SAIS_P3 ksa_sa64_p3
 #else
 typedef int32_t saint_t;
 #define SAINT_MAX INT32_MAX
+#define SAIS_LIB "msais32"
+#ifndef KSA_CORE32
 #define SAIS_MAIN ksa_sa32
+#define SAIS_MAIN_OMP ksa_sa32_omp
+#define SAIS_BWT ksa_bwt32
+#define SAIS_LCP ksa_sa_lcp32
+#define SAIS_DA ksa_da32
+#define SAIS_CTX ksa_sa32_ctx
+#define SAIS_CTX_CREATE ksa_ctx_create32
+#define SAIS_CTX_DESTROY ksa_ctx_destroy32
+#define SAIS_EXTRA ksa_extra_bytes32
+#define SAIS_P3 ksa_sa32_p3
+#endif
+#endif
+
+#define KSA_BLOCK_SIZE 16384 // number of SA entries per thread in one block of the blocked induction
+
+#ifndef KSA_BLOCKED
+#define KSA_BLOCKED 1 // use the blocked induction with a single thread; 0 for the plain induceSA()
+#endif
+
+#ifndef KSA_BLOCKED_MIN
+#define KSA_BLOCKED_MIN (1LL<<28) // min bytes of T for single-threaded blocked induction; smaller T stays in cache
+#endif
+
+#ifndef KSA_PREFETCH_DIST
+#define KSA_PREFETCH_DIST 32 // number of SA entries to look ahead when gathering
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ksa_prefetch(p) __builtin_prefetch((p), 0, 0)
+#define KSA_INLINE inline __attribute__((always_inline))
+#else
+#define ksa_prefetch(p)
+#define KSA_INLINE inline
+#endif
+
+/* In blocked induction, symbols preceding the suffixes in a block of SA are
+ * gathered with prefetching, possibly by multiple threads; only the bucket
+ * update is serial. */
+typedef struct {
+	saint_t j;  // SA value seen at the time of gathering
+	saint_t c;  // chr0(j-1)<<1 | whether j-1 is LML (L pass) or LMS (S pass)
+} ksa_cache_t;
+
+/* In the BWT mode, the final induction writes the preceding symbol instead of
+ * the suffix position once an SA entry is finalized. */
+typedef struct {
+	saint_t ns;       // number of sentinels
+	const saint_t *S; // positions of sentinels in the ascending order
+	saint_t *I;       // I[i] is the row of the suffix starting the i-th string; can be NULL
+} ksa_bwt_t;
+
+#ifndef KSA_SHARED_TYPES // defined once, by the 32-bit core if it is included first
+#define KSA_SHARED_TYPES
+
+/* Options and buffers shared by all recursion levels; same in the 32-bit and the 64-bit builds */
+typedef struct {
+	int n_threads;
+	void *cache;       // cache_len(n_threads) 64-bit ksa_cache_t for blocked induction; NULL to use induceSA()
+	void *arena;       // preallocated space for C and B; NULL to call malloc() at each level
+	size_t arena_size; // size of arena in bytes
+} ksa_aux_t;
+
+struct ksa_ctx_s { // same in the 32-bit and the 64-bit builds
+	void *arena;
+	size_t size;
+	int n_threads;
+};
 #endif
 
-// T is of type "const uint8_t*". If T[i] is a sentinel, chr(i) takes a negative value
-#define chr(i) (cs == sizeof(saint_t) ? ((const saint_t *)T)[i] : (T[i]? (saint_t)T[i] : i - SAINT_MAX))
-#define chr0(i) (cs == sizeof(saint_t) ? ((const saint_t *)T)[i] : T[i])
+#define KSA_CS_P3 0 // cs of a top-level text packed by ksa_set3()
+
+// T is of type "const uint8_t*". If T[i] is a sentinel, chr(i) takes a negative value.
+// Functions using these are inlined into instances with cs being a constant; see induce() and sais_core().
+#define chr8(i) (cs == KSA_CS_P3? ksa_get3(T, (i)) : T[i])
+#define chr(i) (cs == sizeof(saint_t) ? ((const saint_t *)T)[i] : (chr8(i)? (saint_t)chr8(i) : (i) - SAINT_MAX))
+#define chr0(i) (cs == sizeof(saint_t) ? ((const saint_t *)T)[i] : chr8(i))
+#define chr_addr(i) (cs == KSA_CS_P3? T + ((i) >> 3) * 3 : T + (i) * cs)
+
+#define ksa_tbytes(n, cs) ((cs) == KSA_CS_P3? (int64_t)(n) * 3 / 8 : (int64_t)(n) * (cs)) // for profiling only
+#define ksa_sbytes(n) ((int64_t)(n) * (int64_t)sizeof(saint_t))
 
 /** Count the occurrences of each symbol */
-static void getCounts(const uint8_t *T, saint_t *C, saint_t n, saint_t k, int cs)
+static KSA_INLINE void getCounts(const uint8_t *T, saint_t *C, saint_t n, saint_t k, int cs, int n_threads)
 {
 	saint_t i;
 	for (i = 0; i < k; ++i) C[i] = 0;
+#ifdef _OPENMP
+	if (n_threads > 1 && cs != sizeof(saint_t)) { // k <= 256; per-thread counts are cheap
+		#pragma omp parallel num_threads(n_threads)
+		{
+			saint_t c[256], t;
+			for (t = 0; t < k; ++t) c[t] = 0;
+			#pragma omp for schedule(static) nowait
+			for (i = 0; i < n; ++i) ++c[chr8(i)];
+			#pragma omp critical
+			for (t = 0; t < k; ++t) C[t] += c[t];
+		}
+		return;
+	}
+#endif
 	for (i = 0; i < n; ++i) ++C[chr0(i)];
 }
 
+/** Set SA[st..en-1] to 0 */
+static void clearSA(saint_t *SA, saint_t st, saint_t en, int n_threads)
+{
+	saint_t i;
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static) if(n_threads > 1)
+#endif
+	for (i = st; i < en; ++i) SA[i] = 0;
+}
+
 /**
  * Find the start or end of each bucket
  *
@@ -79,13 +258,13 @@ static inline void getBuckets(const saint_t *C, saint_t *B, saint_t k, saint_t e
  * @param cs        bytes per symbol; typically 1 for the first iteration
  * @param LMS_only  if false, populate all SA values; otherwise, only LMS positions are positive in SA
  */
-static void induceSA(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int cs, int LMS_only)
+static KSA_INLINE void induceSA(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int cs, int LMS_only)
 {
 	saint_t *b, i, j;
 	saint_t  c0, c1;
 
 	// induce L from LMS (left-to-right)
-	if (C == B) getCounts(T, C, n, k, cs);
+	if (C == B) getCounts(T, C, n, k, cs, 1);
 	getBuckets(C, B, k, 0);	// find starts of buckets
 	for (i = 0, b = SA, c1 = 0; i < n; ++i) {
 		j = SA[i], SA[i] = ~j;
@@ -98,7 +277,7 @@ static void induceSA(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, sain
 	} // at the end of the loop, only LML are positive in SA[]
 
 	// induce S from LML (right-to-left)
-	if (C == B) getCounts(T, C, n, k, cs);
+	if (C == B) getCounts(T, C, n, k, cs, 1);
 	getBuckets(C, B, k, 1);	// find ends of buckets
 	if (LMS_only) // set negative values to 0 except the 0/sentinel bucket
 		for (i = B[0]; i < n; ++i)
@@ -116,6 +295,265 @@ static void induceSA(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, sain
 	}
 }
 
+/** Gather the preceding symbols of SA[st..en-1] for the L pass */
+static void gatherL(const uint8_t *T, const saint_t *SA, ksa_cache_t *cache, saint_t st, saint_t en, int cs, int n_threads)
+{
+	saint_t i;
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static) if(n_threads > 1)
+#endif
+	for (i = st; i < en; ++i) {
+		saint_t j = SA[i], c0;
+		if (i + KSA_PREFETCH_DIST < en && SA[i + KSA_PREFETCH_DIST] > 1)
+			ksa_prefetch(chr_addr(SA[i + KSA_PREFETCH_DIST] - 2));
+		cache[i - st].j = j;
+		if (j > 0) {
+			c0 = chr0(j - 1);
+			cache[i - st].c = c0 << 1 | (j > 1 && chr0(j - 2) < c0);
+		}
+	}
+}
+
+/** Gather the preceding symbols of SA[st..en-1] for the S pass */
+static void gatherS(const uint8_t *T, const saint_t *SA, ksa_cache_t *cache, saint_t st, saint_t en, int cs, int n_threads)
+{
+	saint_t i;
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static) if(n_threads > 1)
+#endif
+	for (i = st; i < en; ++i) {
+		saint_t j = SA[i], c0;
+		if (i + KSA_PREFETCH_DIST < en && SA[i + KSA_PREFETCH_DIST] > 1)
+			ksa_prefetch(chr_addr(SA[i + KSA_PREFETCH_DIST] - 2));
+		cache[i - st].j = j;
+		if (j > 0) {
+			c0 = chr0(j - 1);
+			cache[i - st].c = c0 << 1 | (j == 1 || chr0(j - 2) > c0);
+		}
+	}
+}
+
+/**
+ * Induced sort with symbol lookups done ahead of the bucket updates
+ *
+ * SA is processed in blocks of n_threads*KSA_BLOCK_SIZE entries. For each
+ * block, the random accesses to T are done first with prefetching and by all
+ * threads; the serial scan then only touches the bucket pointers. A slot
+ * filled during the scan of the same block has no valid cache and is looked
+ * up on the fly.
+ */
+static KSA_INLINE void induceSA_blk(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int cs, int LMS_only, ksa_cache_t *cache, int n_threads)
+{
+	saint_t *b, i, j, st, en, blk = (saint_t)n_threads * KSA_BLOCK_SIZE;
+	saint_t  c0, c1, f;
+
+	// induce L from LMS (left-to-right)
+	if (C == B) getCounts(T, C, n, k, cs, n_threads);
+	getBuckets(C, B, k, 0);
+	for (st = 0, b = SA, c1 = 0; st < n; st = en) {
+		en = st + blk < n? st + blk : n;
+		gatherL(T, SA, cache, st, en, cs, n_threads);
+		for (i = st; i < en; ++i) {
+			j = SA[i], SA[i] = ~j;
+			if (j > 0) {
+				if (cache[i - st].j == j) c0 = cache[i - st].c >> 1, f = cache[i - st].c & 1;
+				else c0 = chr0(j - 1), f = (j > 1 && chr0(j - 2) < c0);
+				--j;
+				if (c0 != c1)
+					B[c1] = b - SA, b = SA + B[c1 = c0];
+				*b++ = f? ~j : j;
+			}
+		}
+	}
+
+	// induce S from LML (right-to-left)
+	if (C == B) getCounts(T, C, n, k, cs, n_threads);
+	getBuckets(C, B, k, 1);
+	if (LMS_only) {
+#ifdef _OPENMP
+		#pragma omp parallel for num_threads(n_threads) schedule(static) if(n_threads > 1)
+#endif
+		for (i = B[0]; i < n; ++i)
+			if (SA[i] < 0) SA[i] = 0;
+	}
+	for (en = n, b = SA + B[c1 = 0]; en > 0; en = st) {
+		st = en > blk? en - blk : 0;
+		gatherS(T, SA, cache, st, en, cs, n_threads);
+		for (i = en - 1; i >= st; --i) {
+			j = SA[i];
+			if (LMS_only || j <= 0) SA[i] = ~j;
+			if (j > 0) {
+				if (cache[i - st].j == j) c0 = cache[i - st].c >> 1, f = cache[i - st].c & 1;
+				else c0 = chr0(j - 1), f = (j == 1 || chr0(j - 2) > c0);
+				--j;
+				if (c0 != c1)
+					B[c1] = b - SA, b = SA + B[c1 = c0];
+				if (c0 > 0)
+					*--b = f? ~j : j;
+			}
+		}
+	}
+}
+
+/** Number of ksa_cache_t in the buffer for induceSA_blk(); 0 to use induceSA() */
+static inline size_t cache_len(int n_threads)
+{
+	return n_threads > 1 || KSA_BLOCKED? (size_t)n_threads * KSA_BLOCK_SIZE : 0;
+}
+
+static KSA_INLINE void induce_cs(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int cs, int LMS_only, const ksa_aux_t *aux)
+{
+	if (aux->cache && (aux->n_threads > 1 || (int64_t)(chr_addr(n) - T) >= KSA_BLOCKED_MIN))
+		induceSA_blk(T, SA, C, B, n, k, cs, LMS_only, (ksa_cache_t*)aux->cache, aux->n_threads);
+	else induceSA(T, SA, C, B, n, k, cs, LMS_only);
+}
+
+/** Induced sort on 8-bit symbols with implicit sentinels */
+static void induce8(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int LMS_only, const ksa_aux_t *aux)
+{
+	induce_cs(T, SA, C, B, n, k, 1, LMS_only, aux);
+}
+
+/** Induced sort on a 3-bit packed string */
+static void induce3(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int LMS_only, const ksa_aux_t *aux)
+{
+	induce_cs(T, SA, C, B, n, k, KSA_CS_P3, LMS_only, aux);
+}
+
+/** Induced sort on saint_t symbols of a reduced string */
+static void induceI(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int LMS_only, const ksa_aux_t *aux)
+{
+	induce_cs(T, SA, C, B, n, k, sizeof(saint_t), LMS_only, aux);
+}
+
+static inline void induce(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, int cs, int LMS_only, const ksa_aux_t *aux)
+{
+	if (cs == 1) induce8(T, SA, C, B, n, k, LMS_only, aux);
+	else if (cs == KSA_CS_P3) induce3(T, SA, C, B, n, k, LMS_only, aux);
+	else induceI(T, SA, C, B, n, k, LMS_only, aux);
+}
+
+/**
+ * Get the C and B arrays from the free space in SA, the arena or the heap
+ *
+ * @return 1 if allocated from the heap, 0 if not, or -1 on failure
+ */
+static int getCB(saint_t *SA, saint_t fs, saint_t n, saint_t k, int cs, const ksa_aux_t *aux, saint_t **C, saint_t **B)
+{
+	saint_t size = k * (1 + (cs != sizeof(saint_t)));
+	if (k <= fs) {
+		*C = SA + n, *B = (k <= fs - k) ? *C + k : *C;
+		return 0;
+	}
+	if (size * sizeof(saint_t) <= aux->arena_size) *C = (saint_t*)aux->arena;
+	else if ((*C = (saint_t*)malloc(size * sizeof(saint_t))) == NULL) return -1;
+	*B = cs != sizeof(saint_t)? *C + k : *C;
+	return *C != (saint_t*)aux->arena;
+}
+
+/** Record the row of suffix p, which starts a string */
+static inline void bwt_set_I(ksa_bwt_t *bwt, saint_t p, saint_t row)
+{
+	saint_t l = 0, r = bwt->ns - 1;
+	if (bwt->I == 0) return;
+	if (p == 0) {
+		bwt->I[0] = row;
+		return;
+	}
+	while (l < r) { // find p-1 in S[]
+		saint_t c = l + ((r - l) >> 1);
+		if (bwt->S[c] < p - 1) l = c + 1;
+		else r = c;
+	}
+	bwt->I[l + 1] = row;
+}
+
+/**
+ * The final induced sort for the 8-bit input, writing BWT symbols to SA
+ *
+ * An L-type entry is finalized in the left-to-right pass and an S-type entry
+ * in the right-to-left pass. Entries no longer needed for induction keep the
+ * complement of the preceding symbol, which is flipped in the last pass.
+ */
+static void induceBWT(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, saint_t n, saint_t k, ksa_bwt_t *bwt)
+{
+	saint_t *b, i, j;
+	saint_t  c0, c1;
+
+	// induce L from LMS (left-to-right)
+	if (C == B) getCounts(T, C, n, k, 1, 1);
+	getBuckets(C, B, k, 0);
+	for (i = 0, b = SA, c1 = 0; i < n; ++i) {
+		j = SA[i];
+		if (j > 0) {
+			--j;
+			if ((c0 = T[j]) != c1)
+				B[c1] = b - SA, b = SA + B[c1 = c0];
+			if (j == 0) bwt_set_I(bwt, 0, b - SA);
+			*b++ = j > 0 && T[j - 1] < c1? ~j : j;
+			if (c0 == 0) bwt_set_I(bwt, j + 1, i);
+			SA[i] = ~c0;
+		} else SA[i] = ~j;
+	}
+
+	// induce S from LML (right-to-left)
+	if (C == B) getCounts(T, C, n, k, 1, 1);
+	getBuckets(C, B, k, 1);
+	for (i = n - 1, b = SA + B[c1 = 0]; i >= 0; --i) {
+		j = SA[i];
+		if (j <= 0) {
+			SA[i] = ~j;
+			continue;
+		}
+		--j;
+		if ((c0 = T[j]) != c1)
+			B[c1] = b - SA, b = SA + B[c1 = c0];
+		if (c0 > 0) {
+			if (j == 0) *--b = ~0, bwt_set_I(bwt, 0, b - SA);
+			else *--b = T[j - 1] > c1? ~(saint_t)T[j - 1] : j;
+		}
+		if (c0 == 0) bwt_set_I(bwt, j + 1, i);
+		SA[i] = c0;
+	}
+}
+
+#if defined(_KSA64) || defined(MSAIS64)
+/**
+ * Solve the reduced problem with the 32-bit sais_core()
+ *
+ * RA[0..m] is converted in place to 32-bit integers placed at the end of SA or,
+ * if the 32-bit workspace would be too large, right before RA. On return,
+ * SA[1..m] is the same as what the 64-bit recursion leaves.
+ *
+ * @return 0 upon success, 1 if the 32-bit workspace is insufficient, and
+ *         negative on errors
+ */
+static int sais_reduced32(int64_t *SA, int64_t fs, int64_t n, int64_t m, int64_t name, const ksa_aux_t *aux)
+{
+	int32_t *S32 = (int32_t*)SA, *RA32;
+	int64_t *RA = SA + n + fs - m - 1, i, fs32 = 2 * (n + fs) - 2 * (m + 1);
+	SAPROF_DECL(prof);
+	if (fs32 + m + 1 <= INT32_MAX) { // RA32 at the end; RA32[i] never goes beyond RA[i+1..]
+		RA32 = S32 + m + 1 + fs32;
+		for (i = m; i >= 0; --i) RA32[i] = (int32_t)RA[i];
+	} else { // RA32 entirely before RA
+		fs32 = 2 * (n + fs) - 4 * (m + 1);
+		if (fs32 > INT32_MAX - (m + 1)) fs32 = INT32_MAX - (m + 1);
+		if (fs32 < 0) return 1;
+		RA32 = S32 + m + 1 + fs32;
+		for (i = 0; i <= m; ++i) RA32[i] = (int32_t)RA[i];
+	}
+	SAPROF_LAP(prof, SAIS_LIB, "to 32-bit", 12 * (m + 1));
+	if (ksa_core32((uint8_t*)RA32, S32, (int32_t)fs32, (int32_t)m + 1, (int32_t)name + 1, sizeof(int32_t), aux) != 0) return -2;
+	SAPROF_SKIP(prof); // timed by ksa_core32()
+	for (i = m; i > 0; --i) SA[i] = S32[i]; // backward as SA[i] covers S32[2i..2i+1]
+	SAPROF_LAP(prof, SAIS_LIB, "to 64-bit", 12 * m);
+	return 0;
+}
+#endif
+
+static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint_t k, int cs, const ksa_aux_t *aux, ksa_bwt_t *bwt);
+
 /**
  * Recursively construct the suffix array for a string containing multiple
  * sentinels. NULL is taken as the sentinel.
@@ -126,35 +564,36 @@ static void induceSA(const uint8_t *T, saint_t *SA, saint_t *C, saint_t *B, sain
  * @param n   length of T, including the trailing NULL
  * @param k   size of the alphabet (typically 256 when first called)
  * @param cs  bytes per symbol; typically 1 for the first iteration
+ * @param aux  threads and buffers shared by all levels
+ * @param bwt  output BWT instead of SA if not NULL; only for the top level
  *
  * @return    0 upon success
  */
-static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint_t k, int cs)
+static KSA_INLINE int sais_core_cs(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint_t k, int cs, const ksa_aux_t *aux, ksa_bwt_t *bwt)
 {
 	saint_t *C, *B;
 	saint_t  i, j, c, m, q, qlen, name;
 	saint_t  c0, c1;
+	int      n_threads = aux->n_threads, heap, ret = 1;
+	SAPROF_DECL(prof);
 
 	// STAGE I: reduce the problem by at least 1/2 sort all the S-substrings
-	if (k <= fs) C = SA + n, B = (k <= fs - k) ? C + k : C;
-	else {
-		if ((C = (saint_t*)malloc(k * (1 + (cs == 1)) * sizeof(saint_t))) == NULL) return -2;
-		B = cs == 1? C + k : C;
-	}
-	getCounts(T, C, n, k, cs);
+	if ((heap = getCB(SA, fs, n, k, cs, aux, &C, &B)) < 0) return -2;
+	getCounts(T, C, n, k, cs, n_threads);
 	getBuckets(C, B, k, 1);	// find ends of buckets
-	for (i = 0; i < n; ++i) SA[i] = 0;
+	clearSA(SA, 0, n, n_threads);
 	// find LMS and keep their positions in the buckets
 	for (i = n - 2, c = 1, c1 = chr0(n - 1); 0 <= i; --i, c1 = c0) {
 		if ((c0 = chr0(i)) < c1 + c) c = 1; // c1 = chr(i+1); c==1 if in an S run
 		else if (c) SA[--B[c1]] = i + 1, c = 0;
 	}
-	induceSA(T, SA, C, B, n, k, cs, 1);
-	if (fs < k) free(C);
+	induce(T, SA, C, B, n, k, cs, 1, aux);
+	if (heap) free(C);
+	SAPROF_LAP(prof, SAIS_LIB, "sort LMS", 3 * ksa_tbytes(n, cs) + 2 * ksa_sbytes(n));
 	// pack all the sorted LMS into the first m items of SA; 2*m <= n
 	for (i = 0, m = 0; i < n; ++i)
 		if (SA[i] > 0) SA[m++] = SA[i];
-	for (i = m; i < n; ++i) SA[i] = 0;	// init the name array buffer
+	clearSA(SA, m, n, n_threads);	// init the name array buffer
 	// store the length of all substrings
 	for (i = n - 2, j = n, c = 1, c1 = chr0(n - 1); i >= 0; --i, c1 = c0) {
 		if ((c0 = chr0(i)) < c1 + c) c = 1; // c1 = chr(i+1)
@@ -170,6 +609,7 @@ static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint
 		if (diff) ++name, q = p, qlen = plen;
 		SA[m + (p >> 1)] = name;
 	}
+	SAPROF_LAP(prof, SAIS_LIB, "name LMS", ksa_tbytes(n, cs) + 2 * ksa_sbytes(n));
 
 	// STAGE II: solve the reduced problem; recurse if names are not yet unique
 	if (name < m) {
@@ -177,33 +617,70 @@ static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint
 		for (i = n - 1, j = m - 1; m <= i; --i)
 			if (SA[i] != 0) RA[j--] = SA[i];
 		RA[m] = 0; // add a sentinel; in the resulting SA, SA[0]==m always stands
-		if (sais_core((uint8_t*)RA, SA, fs + n - m * 2 - 2, m + 1, name + 1, sizeof(saint_t)) != 0) return -2;
+		SAPROF_LAP(prof, SAIS_LIB, "reduce", ksa_sbytes(n));
+		SAPROF_ENTER();
+#if defined(_KSA64) || defined(MSAIS64)
+		if (m < INT32_MAX) ret = sais_reduced32(SA, fs, n, m, name, aux); // halve the memory traffic of the remaining levels
+#endif
+		if (ret > 0) ret = sais_core((uint8_t*)RA, SA, fs + n - m * 2 - 2, m + 1, name + 1, sizeof(saint_t), aux, 0);
+		if (ret != 0) return -2;
+		SAPROF_LEAVE(prof);
 		for (i = n - 2, j = m - 1, c = 1, c1 = chr(n - 1); 0 <= i; --i, c1 = c0) {
 			if ((c0 = chr(i)) < c1 + c) c = 1;
 			else if (c) RA[j--] = i + 1, c = 0;
 		}
 		for (i = 0; i < m; ++i) SA[i] = RA[SA[i+1]];
+		SAPROF_LAP(prof, SAIS_LIB, "reconstruct", ksa_tbytes(n, cs) + 3 * ksa_sbytes(m));
 	}
 
 	// STAGE III: induce the result for the original problem
-	if (k <= fs) C = SA + n, B = (k <= fs - k) ? C + k : C;
-	else {
-		if ((C = (saint_t*)malloc(k * (1 + (cs == 1)) * sizeof(saint_t))) == NULL) return -2;
-		B = cs == 1? C + k : C;
-	}
+	if ((heap = getCB(SA, fs, n, k, cs, aux, &C, &B)) < 0) return -2;
 	// put all LMS characters into their buckets
-	getCounts(T, C, n, k, cs);
+	getCounts(T, C, n, k, cs, n_threads);
 	getBuckets(C, B, k, 1);	// find ends of buckets
-	for (i = m; i < n; ++i) SA[i] = 0;
+	clearSA(SA, m, n, n_threads);
 	for (i = m - 1; 0 <= i; --i) {
 		j = SA[i], SA[i] = 0;
 		SA[--B[chr0(j)]] = j;
 	}
-	induceSA(T, SA, C, B, n, k, cs, 0);
-	if (fs < k) free(C);
+	if (bwt) induceBWT(T, SA, C, B, n, k, bwt);
+	else induce(T, SA, C, B, n, k, cs, 0, aux);
+	if (heap) free(C);
+	SAPROF_LAP(prof, SAIS_LIB, "induce final", 3 * ksa_tbytes(n, cs) + 2 * ksa_sbytes(n));
 	return 0;
 }
 
+/** Instantiate sais_core_cs() for the 8-bit or the packed top level and for the reduced strings */
+static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint_t k, int cs, const ksa_aux_t *aux, ksa_bwt_t *bwt)
+{
+	if (cs == 1) return sais_core_cs(T, SA, fs, n, k, 1, aux, bwt);
+	if (cs == KSA_CS_P3) return sais_core_cs(T, SA, fs, n, k, KSA_CS_P3, aux, 0);
+	return sais_core_cs(T, SA, fs, n, k, sizeof(saint_t), aux, bwt);
+}
+
+#ifdef KSA_CORE32
+/** Recursion entry for the 64-bit build once the reduced problem fits in 32 bits */
+static int ksa_core32(const uint8_t *T, int32_t *SA, int32_t fs, int32_t n, int32_t k, int cs, const ksa_aux_t *aux)
+{
+	return sais_core(T, SA, fs, n, k, cs, aux, 0);
+}
+#else // the rest is not part of the 32-bit core
+
+/** Allocate the buffer for the induction and construct SA; cs is 1 or KSA_CS_P3 */
+static int sais_main(const uint8_t *T, saint_t *SA, saint_t n, int k, int cs, int n_threads)
+{
+	int ret;
+	ksa_aux_t aux = { 1, 0, 0, 0 };
+#ifdef _OPENMP
+	if (n_threads <= 0) n_threads = omp_get_max_threads();
+	aux.n_threads = n_threads;
+#endif
+	if (cache_len(aux.n_threads) > 0 && (aux.cache = malloc(cache_len(aux.n_threads) * sizeof(ksa_cache_t))) == NULL) return -2;
+	ret = sais_core(T, SA, 0, n, (saint_t)k, cs, &aux, 0);
+	free(aux.cache);
+	return ret;
+}
+
 /**
  * Construct the suffix array for a NULL terminated string possibly containing
  * multiple sentinels (NULLs).
@@ -215,8 +692,373 @@ static int sais_core(const uint8_t *T, saint_t *SA, saint_t fs, saint_t n, saint
  * @return           0 upon success
  */
 int SAIS_MAIN(const uint8_t *T, saint_t *SA, saint_t n, int k)
+{
+	return SAIS_MAIN_OMP(T, SA, n, k, 1);
+}
+
+/**
+ * Construct the suffix array with multiple threads
+ *
+ * @param n_threads  number of threads; ignored if not compiled with OpenMP
+ *
+ * See SAIS_MAIN() for other parameters. Only the buffer of n_threads *
+ * KSA_BLOCK_SIZE entries is allocated in addition to the plain induction.
+ */
+int SAIS_MAIN_OMP(const uint8_t *T, saint_t *SA, saint_t n, int k, int n_threads)
 {
 	if (T == NULL || SA == NULL || n <= 0 || T[n - 1] != '\0') return -1;
 	if (k < 0 || k > 256) k = 256;
-	return sais_core(T, SA, 0, n, (saint_t)k, 1);
+	return sais_main(T, SA, n, k, 1, n_threads);
+}
+
+/**
+ * Construct the suffix array for a 3-bit packed string
+ *
+ * @param P  string packed by ksa_set3(); symbol n-1 must be 0
+ * @param k  size of the alphabet including the sentinel; no more than 8
+ *
+ * See SAIS_MAIN_OMP() for other parameters.
+ */
+int SAIS_P3(const uint8_t *P, saint_t *SA, saint_t n, int k, int n_threads)
+{
+	if (P == NULL || SA == NULL || n <= 0 || ksa_get3(P, n - 1) != 0) return -1;
+	if (k < 0 || k > 8) k = 8;
+	return sais_main(P, SA, n, k, KSA_CS_P3, n_threads);
 }
+
+/**
+ * Size of the arena needed by SAIS_CTX() to avoid all heap allocations
+ *
+ * @param n          length of the string, including NULL
+ * @param n_threads  number of threads
+ *
+ * @return    number of bytes
+ */
+size_t SAIS_EXTRA(saint_t n, int n_threads)
+{
+	size_t size = n / 2 + 1 > 512? n / 2 + 1 : 512; // C and B at all levels; the alphabet of a reduced string is no larger than its length
+	size *= sizeof(saint_t);
+#ifdef _OPENMP
+	if (n_threads <= 0) n_threads = omp_get_max_threads();
+#else
+	n_threads = 1;
+#endif
+	return size + cache_len(n_threads) * sizeof(ksa_cache_t);
+}
+
+/**
+ * Construct the suffix array with a preallocated context
+ *
+ * The arena in the context holds the buffer for blocked induction first and
+ * the bucket arrays of every level afterwards. A level falls back to malloc()
+ * if the remaining arena is too small. See SAIS_MAIN() for other parameters.
+ */
+int SAIS_CTX(ksa_ctx_t *ctx, const uint8_t *T, saint_t *SA, saint_t n, int k)
+{
+	ksa_aux_t aux = { 1, 0, 0, 0 };
+	size_t cache_size;
+	if (ctx == NULL || T == NULL || SA == NULL || n <= 0 || T[n - 1] != '\0') return -1;
+	if (k < 0 || k > 256) k = 256;
+	cache_size = cache_len(ctx->n_threads) * sizeof(ksa_cache_t);
+	if (cache_size > 0 && cache_size <= ctx->size)
+		aux.n_threads = ctx->n_threads, aux.cache = ctx->arena;
+	else cache_size = 0; // single-threaded with the plain induction
+	aux.arena = (uint8_t*)ctx->arena + cache_size;
+	aux.arena_size = ctx->size - cache_size;
+	return sais_core(T, SA, 0, n, (saint_t)k, 1, &aux, 0);
+}
+
+/**
+ * Construct the BWT for a NULL terminated string possibly containing multiple
+ * sentinels (NULLs).
+ *
+ * @param T[0..n-1]  NULL terminated input string
+ * @param U[0..n-1]  output BWT; can be T
+ * @param SA[0..n-1] working space
+ * @param n          length of the given string, including NULL
+ * @param k          size of the alphabet including the sentinel; no more than 256
+ * @param I          I[i] is the row of the suffix starting the i-th string; can be NULL
+ * @return           number of strings upon success; negative on errors
+ */
+saint_t SAIS_BWT(const uint8_t *T, uint8_t *U, saint_t *SA, saint_t n, int k, saint_t *I)
+{
+	saint_t i, ns, *S;
+	ksa_bwt_t bwt;
+	ksa_aux_t aux = { 1, 0, 0, 0 };
+	if (T == NULL || U == NULL || SA == NULL || n <= 0 || T[n - 1] != '\0') return -1;
+	if (k < 0 || k > 256) k = 256;
+	for (i = ns = 0; i < n; ++i)
+		if (T[i] == 0) ++ns;
+	if ((S = (saint_t*)malloc(ns * sizeof(saint_t))) == NULL) return -2;
+	for (i = ns = 0; i < n; ++i)
+		if (T[i] == 0) S[ns++] = i;
+	bwt.ns = ns, bwt.S = S, bwt.I = I;
+	if (sais_core(T, SA, 0, n, (saint_t)k, 1, &aux, &bwt) != 0) {
+		free(S);
+		return -2;
+	}
+	free(S);
+	if (I && T[0] == 0) I[0] = 0; // the first string is empty: its sentinel is the smallest suffix and never induced
+	for (i = 0; i < n; ++i) U[i] = SA[i];
+	return ns;
+}
+
+/**
+ * Compute the permuted LCP array with the Phi algorithm
+ *
+ * Sentinels are distinct, so matching stops at the first NULL. The
+ * "PLCP[i+1] >= PLCP[i]-1" property still holds with this rule. With multiple
+ * threads, each thread takes a contiguous range of positions and starts its
+ * range from l = 0, which is always a valid lower bound.
+ */
+static void plcp_phi(const uint8_t *T, const saint_t *SA, saint_t *PLCP, saint_t n, int n_threads)
+{
+	saint_t i;
+	int c;
+	PLCP[SA[0]] = -1;
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static) if(n_threads > 1)
+#endif
+	for (i = 1; i < n; ++i) PLCP[SA[i]] = SA[i - 1];
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static, 1) if(n_threads > 1)
+#endif
+	for (c = 0; c < n_threads; ++c) {
+		saint_t i, l = 0, e = (saint_t)((int64_t)n * (c + 1) / n_threads);
+		for (i = (saint_t)((int64_t)n * c / n_threads); i < e; ++i) {
+			saint_t j = PLCP[i];
+			if (j < 0) {
+				PLCP[i] = l = 0;
+				continue;
+			}
+			while (T[i + l] == T[j + l] && T[i + l] != 0) ++l;
+			PLCP[i] = l;
+			l = l > 0? l - 1 : 0;
+		}
+	}
+}
+
+/**
+ * Permute PLCP to LCP in place with LCP[i] = PLCP[SA[i]]
+ *
+ * Each cycle of the permutation is followed once; visited SA entries are
+ * marked by flipping their bits and restored at the end.
+ */
+static void plcp2lcp(saint_t *SA, saint_t *LCP, saint_t n)
+{
+	saint_t i;
+	for (i = 0; i < n; ++i) {
+		saint_t j, k, t;
+		if (SA[i] < 0) continue;
+		for (j = i, t = LCP[i]; (k = SA[j]) != i; j = k)
+			LCP[j] = LCP[k], SA[j] = ~k;
+		LCP[j] = t, SA[j] = ~k;
+	}
+	for (i = 0; i < n; ++i) SA[i] = ~SA[i];
+}
+
+#ifdef _OPENMP
+/** Claim position x for the calling walk by flipping SA[x]; return 0 if another walk has it */
+static inline int cycle_claim(saint_t *SA, saint_t x)
+{
+	saint_t v = SA[x];
+	return v >= 0 && __sync_bool_compare_and_swap(&SA[x], v, ~v);
+}
+
+/** Find the value kept by the cut walk starting at s; cut[] holds (start, value, end, next) sorted by start */
+static saint_t cut_value(const saint_t *cut, size_t n_cut, saint_t s)
+{
+	size_t lo = 0, hi = n_cut;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (cut[mid * 4] < s) lo = mid + 1;
+		else hi = mid;
+	}
+	return cut[lo * 4 + 1];
+}
+
+/**
+ * Multi-threaded plcp2lcp()
+ *
+ * Threads follow cycles from the positions in their ranges and claim each
+ * position with a compare-and-swap on SA. A walk that runs into a position
+ * claimed by another walk stops there, so one cycle may be cut into several
+ * walks. The end of a cut walk gets its value from the start of the next walk
+ * once all threads are done; only the cut walks are recorded for this.
+ *
+ * @return 0 on success and -2 on allocation failure; SA is restored either way
+ */
+static int plcp2lcp_omp(saint_t *SA, saint_t *LCP, saint_t n, int n_threads)
+{
+	saint_t **cut, *all = 0, i;
+	size_t *n_cut, *m_cut, tot = 0;
+	int t, err = 0;
+	cut = (saint_t**)calloc(n_threads, sizeof(saint_t*));
+	n_cut = (size_t*)calloc(n_threads, sizeof(size_t));
+	m_cut = (size_t*)calloc(n_threads, sizeof(size_t));
+	if (cut == NULL || n_cut == NULL || m_cut == NULL) {
+		free(cut); free(n_cut); free(m_cut);
+		return -2;
+	}
+	#pragma omp parallel for num_threads(n_threads) schedule(static, 1) reduction(|:err)
+	for (t = 0; t < n_threads; ++t) { // thread t walks from [n*t/n_threads, n*(t+1)/n_threads) in order, so its cuts are sorted
+		saint_t i, e = (saint_t)((int64_t)n * (t + 1) / n_threads);
+		for (i = (saint_t)((int64_t)n * t / n_threads); i < e && !err; ++i) {
+			saint_t j, k, v;
+			if (!cycle_claim(SA, i)) continue;
+			for (j = i, v = LCP[i]; (k = ~SA[j]) != i && cycle_claim(SA, k); j = k)
+				LCP[j] = LCP[k];
+			if (k == i) {
+				LCP[j] = v;
+				continue;
+			}
+			if (n_cut[t] == m_cut[t]) {
+				saint_t *p;
+				m_cut[t] = m_cut[t]? m_cut[t] << 1 : 256;
+				if ((p = (saint_t*)realloc(cut[t], m_cut[t] * 4 * sizeof(saint_t))) == NULL) {
+					err = 1;
+					break;
+				}
+				cut[t] = p;
+			}
+			cut[t][n_cut[t] * 4] = i, cut[t][n_cut[t] * 4 + 1] = v, cut[t][n_cut[t] * 4 + 2] = j, cut[t][n_cut[t] * 4 + 3] = k;
+			++n_cut[t];
+		}
+	}
+	for (t = 0; t < n_threads; ++t) tot += n_cut[t];
+	if (!err && tot > 0 && (all = (saint_t*)malloc(tot * 4 * sizeof(saint_t))) == NULL) err = 1;
+	if (!err) {
+		size_t c, o = 0;
+		for (t = 0; t < n_threads; ++t) {
+			if (n_cut[t]) memcpy(all + o * 4, cut[t], n_cut[t] * 4 * sizeof(saint_t));
+			o += n_cut[t];
+		}
+		#pragma omp parallel for num_threads(n_threads) schedule(static) if(tot >= 65536)
+		for (c = 0; c < tot; ++c)
+			LCP[all[c * 4 + 2]] = cut_value(all, tot, all[c * 4 + 3]);
+	}
+	#pragma omp parallel for num_threads(n_threads) schedule(static)
+	for (i = 0; i < n; ++i)
+		if (SA[i] < 0) SA[i] = ~SA[i];
+	for (t = 0; t < n_threads; ++t) free(cut[t]);
+	free(cut); free(n_cut); free(m_cut); free(all);
+	return err? -2 : 0;
+}
+#endif
+
+/**
+ * Construct the suffix array and the LCP array
+ *
+ * @param LCP[0..n-1] output LCP array; LCP[0] = 0
+ * @param n_threads   number of threads; <=0 to use the OpenMP default
+ *
+ * See SAIS_MAIN() for other parameters. With one thread, no memory is
+ * allocated in addition to SAIS_MAIN(); with more, the permutation of PLCP
+ * also keeps a record of each cycle cut between threads.
+ *
+ * @return 0 on success, -1 on invalid input and -2 on allocation failure,
+ *         from SAIS_MAIN_OMP() or from the permutation
+ */
+int SAIS_LCP(const uint8_t *T, saint_t *SA, saint_t *LCP, saint_t n, int k, int n_threads)
+{
+	int ret;
+	if (LCP == NULL) return -1;
+#ifdef _OPENMP
+	if (n_threads <= 0) n_threads = omp_get_max_threads();
+#else
+	n_threads = 1;
+#endif
+	if ((ret = SAIS_MAIN_OMP(T, SA, n, k, n_threads)) != 0) return ret;
+	if (n < 65536) n_threads = 1; // not worth the threads
+	plcp_phi(T, SA, LCP, n, n_threads);
+#ifdef _OPENMP
+	if (n_threads > 1) return plcp2lcp_omp(SA, LCP, n, n_threads);
+#endif
+	plcp2lcp(SA, LCP, n);
+	return 0;
+}
+
+/**
+ * Compute the document array from a generalized suffix array
+ *
+ * DA is first filled with the string index of each position in T, which is a
+ * sequential scan, and then permuted in place in the same way as plcp2lcp().
+ * This takes one random access per suffix instead of a binary search over
+ * string offsets.
+ *
+ * @param T[0..n-1]  NULL terminated input string
+ * @param SA[0..n-1] generalized suffix array from any engine; restored on return
+ * @param DA[0..n-1] output document array: DA[i] is the index of the string containing SA[i]
+ * @param n          length of T
+ * @return           0 upon success; -1 if there are more than INT32_MAX strings
+ */
+int SAIS_DA(const uint8_t *T, saint_t *SA, int32_t *DA, saint_t n)
+{
+	saint_t i, ns;
+	if (T == NULL || SA == NULL || DA == NULL || n <= 0) return -1;
+	for (i = 0, ns = 0; i < n; ++i) {
+		DA[i] = (int32_t)ns;
+		if (T[i] == 0 && ++ns > INT32_MAX) return -1;
+	}
+	for (i = 0; i < n; ++i) {
+		saint_t j, k;
+		int32_t t;
+		if (SA[i] < 0) continue;
+		for (j = i, t = DA[i]; (k = SA[j]) != i; j = k)
+			DA[j] = DA[k], SA[j] = ~k;
+		DA[j] = t, SA[j] = ~k;
+	}
+	for (i = 0; i < n; ++i) SA[i] = ~SA[i];
+	return 0;
+}
+
+ksa_ctx_t *SAIS_CTX_CREATE(size_t arena_size, int n_threads)
+{
+	ksa_ctx_t *ctx;
+	if ((ctx = (ksa_ctx_t*)calloc(1, sizeof(*ctx))) == NULL) return NULL;
+#ifdef _OPENMP
+	if (n_threads <= 0) n_threads = omp_get_max_threads();
+#else
+	n_threads = 1;
+#endif
+	ctx->n_threads = n_threads;
+	if (arena_size > 0 && (ctx->arena = malloc(arena_size)) == NULL) {
+		free(ctx);
+		return NULL;
+	}
+	ctx->size = arena_size;
+	return ctx;
+}
+
+void SAIS_CTX_DESTROY(ksa_ctx_t *ctx)
+{
+	if (ctx == NULL) return;
+	free(ctx->arena);
+	free(ctx);
+}
+
+#if defined(_KSA64) || defined(MSAIS64)
+uint8_t *ksa_pack40(int64_t *SA, int64_t n)
+{
+	int64_t i;
+	uint8_t *P = (uint8_t*)SA;
+	if (SA == NULL || n < 0 || n > 1LL<<40) return NULL;
+	for (i = 0; i < n; ++i) { // p[5i..5i+4] never overlaps SA[i+1..]
+		uint64_t x = SA[i];
+		uint8_t *p = P + i * 5;
+		p[0] = x, p[1] = x>>8, p[2] = x>>16, p[3] = x>>24, p[4] = x>>32;
+	}
+	return P;
+}
+
+int64_t *ksa_unpack40(uint8_t *P, int64_t n)
+{
+	int64_t i;
+	int64_t *SA = (int64_t*)P;
+	if (P == NULL || n < 0) return NULL;
+	for (i = n - 1; i >= 0; --i) // backward as SA[i] covers p[5i..5i+4]
+		SA[i] = ksa_get40(P, i);
+	return SA;
+}
+#endif
+#endif // KSA_CORE32
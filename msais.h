@@ -1,6 +1,7 @@
 #ifndef MSAIS_H
 #define MSAIS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -21,6 +22,161 @@ int ksa_sa32(const uint8_t *T, int32_t *SA, int32_t n, int k);
 
 int ksa_sa64(const uint8_t *T, int64_t *SA, int64_t n, int k);
 
+/**
+ * Multi-threaded ksa_sa32()/ksa_sa64(); single-threaded without OpenMP
+ *
+ * @param n_threads  number of threads; <=0 to use the OpenMP default
+ */
+int ksa_sa32_omp(const uint8_t *T, int32_t *SA, int32_t n, int k, int n_threads);
+
+int ksa_sa64_omp(const uint8_t *T, int64_t *SA, int64_t n, int k, int n_threads);
+
+/**
+ * Constructing the generalized suffix array for a 3-bit packed string
+ *
+ * Symbols are decoded on the fly, so the text takes 3n/8 bytes instead of n.
+ *
+ * @param P          string packed with ksa_set3(); symbol n-1 MUST BE 0
+ * @param k          largest symbol plus 1; no more than 8
+ * @param n_threads  number of threads; <=0 to use the OpenMP default
+ *
+ * @return 0 on success and -1 on failure
+ */
+int ksa_sa32_p3(const uint8_t *P, int32_t *SA, int32_t n, int k, int n_threads);
+
+int ksa_sa64_p3(const uint8_t *P, int64_t *SA, int64_t n, int k, int n_threads);
+
+/** Number of bytes to hold n 3-bit symbols; every 8 symbols take 3 bytes */
+#define ksa_p3_size(n) (((n) + 7) / 8 * 3)
+
+/** Get the i-th symbol of a 3-bit packed string */
+static inline int ksa_get3(const uint8_t *P, int64_t i)
+{
+	const uint8_t *p = P + (i >> 3) * 3;
+	uint32_t x = (uint32_t)p[0] | (uint32_t)p[1]<<8 | (uint32_t)p[2]<<16;
+	return x >> (i & 7) * 3 & 7;
+}
+
+/** Set the i-th symbol of a 3-bit packed string; c is in [0,8) */
+static inline void ksa_set3(uint8_t *P, int64_t i, int c)
+{
+	uint8_t *p = P + (i >> 3) * 3;
+	uint32_t x = (uint32_t)p[0] | (uint32_t)p[1]<<8 | (uint32_t)p[2]<<16, s = (i & 7) * 3;
+	x = (x & ~(7U << s)) | (uint32_t)c << s;
+	p[0] = x, p[1] = x>>8, p[2] = x>>16;
+}
+
+typedef struct ksa_ctx_s ksa_ctx_t;
+
+/**
+ * Create a context for repeated suffix array construction
+ *
+ * The context holds an arena for the bucket arrays of all recursion levels and
+ * for the parallel induction buffer. It can be reused across calls of either
+ * width, but not by concurrent calls. ksa_ctx_create32() is in the 32-bit
+ * object and ksa_ctx_create64() in the 64-bit one; they make the same context.
+ *
+ * @param arena_size  arena size in bytes; see ksa_extra_bytes32()/ksa_extra_bytes64()
+ * @param n_threads   number of threads; <=0 to use the OpenMP default
+ *
+ * @return the context, or NULL on allocation failure
+ */
+ksa_ctx_t *ksa_ctx_create32(size_t arena_size, int n_threads);
+
+ksa_ctx_t *ksa_ctx_create64(size_t arena_size, int n_threads);
+
+/** Free a context from either ksa_ctx_create32() or ksa_ctx_create64() */
+void ksa_ctx_destroy32(ksa_ctx_t *ctx);
+
+void ksa_ctx_destroy64(ksa_ctx_t *ctx);
+
+/** Arena size with which ksa_sa32_ctx()/ksa_sa64_ctx() won't call malloc() for a string of length n */
+size_t ksa_extra_bytes32(int32_t n, int n_threads);
+
+size_t ksa_extra_bytes64(int64_t n, int n_threads);
+
+/**
+ * ksa_sa32()/ksa_sa64() with a preallocated context
+ *
+ * A recursion level falls back to malloc() if the arena is too small.
+ *
+ * @return 0 on success and -1 on failure
+ */
+int ksa_sa32_ctx(ksa_ctx_t *ctx, const uint8_t *T, int32_t *SA, int32_t n, int k);
+
+int ksa_sa64_ctx(ksa_ctx_t *ctx, const uint8_t *T, int64_t *SA, int64_t n, int k);
+
+/**
+ * Constructing the generalized suffix array and the LCP array
+ *
+ * LCP is computed with the Phi algorithm, stopping at each sentinel, and then
+ * permuted in place, so little memory is needed beyond SA and LCP. SA, Phi
+ * and the permutation all run on n_threads threads.
+ *
+ * @param LCP        output LCP array of length n; LCP[0] is 0
+ * @param n_threads  number of threads; <=0 to use the OpenMP default
+ *
+ * @return 0 on success, -1 on invalid input and -2 on allocation failure
+ */
+int ksa_sa_lcp32(const uint8_t *T, int32_t *SA, int32_t *LCP, int32_t n, int k, int n_threads);
+
+int ksa_sa_lcp64(const uint8_t *T, int64_t *SA, int64_t *LCP, int64_t n, int k, int n_threads);
+
+/**
+ * Computing the document array (DA) from a generalized suffix array
+ *
+ * SA can be generated by any engine; it is temporarily modified but restored
+ * on return. DA[i] is the 0-based index of the string containing suffix SA[i].
+ *
+ * @return 0 on success and -1 on failure or if there are >INT32_MAX strings
+ */
+int ksa_da32(const uint8_t *T, int32_t *SA, int32_t *DA, int32_t n);
+
+int ksa_da64(const uint8_t *T, int64_t *SA, int32_t *DA, int64_t n);
+
+/**
+ * Constructing the BWT for a string set
+ *
+ * The final induction writes BWT symbols to SA in place of the suffix
+ * positions, so no extra pass over SA or T is needed. A sentinel is kept as
+ * 0 in the BWT; the suffix starting at position 0 is preceded by T[n-1].
+ *
+ * @param T     string with 0 taken as sentinels; T[n-1] MUST BE 0
+ * @param U     output BWT of length n; can be T
+ * @param SA    working space of length n
+ * @param n     number of symbols
+ * @param k     largest symbol plus 1
+ * @param I     I[i] is the BWT row of the suffix starting the i-th string; can be NULL
+ *
+ * @return number of strings on success and negative on failure
+ */
+int32_t ksa_bwt32(const uint8_t *T, uint8_t *U, int32_t *SA, int32_t n, int k, int32_t *I);
+
+int64_t ksa_bwt64(const uint8_t *T, uint8_t *U, int64_t *SA, int64_t n, int k, int64_t *I);
+
+/**
+ * Pack a 64-bit suffix array to 5 bytes per entry in place
+ *
+ * The packed array occupies the first 5*n bytes of SA, which can be shrunk
+ * with realloc() afterwards. Use ksa_get40() to access the packed array.
+ *
+ * @param SA    suffix array with all values in [0,2^40)
+ * @param n     length of SA; no more than 2^40
+ *
+ * @return (uint8_t*)SA on success, or NULL if n is too large
+ */
+uint8_t *ksa_pack40(int64_t *SA, int64_t n);
+
+/** Unpack a 40-bit array in place; P must have room for 8*n bytes */
+int64_t *ksa_unpack40(uint8_t *P, int64_t n);
+
+/** Get the i-th value of a packed 40-bit array */
+static inline int64_t ksa_get40(const uint8_t *P, int64_t i)
+{
+	const uint8_t *p = P + i * 5;
+	return (int64_t)p[0] | (int64_t)p[1]<<8 | (int64_t)p[2]<<16 | (int64_t)p[3]<<24 | (int64_t)p[4]<<32;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,10 +1,14 @@
 #include <stdlib.h>
 #include <stdint.h>
-#include <assert.h>
 #include <stdio.h>
-#include <zlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include "libsais.h"
 #include "libsais64.h"
@@ -12,14 +16,20 @@
 
 #include "msais.h"
 #include "gsacak.h"
+#include "seqio.h"
+#include "saprof.h"
+#include "perfev.h"
+#include "rsslog.h"
+#include "hugemem.h"
+#include "numamem.h"
 
 #include "ketopt.h"
 #include "kseq.h"
-KSEQ_INIT(gzFile, gzread)
+KSEQ_INIT(sio_file_t*, sio_read)
 
-#define Malloc(type, cnt)       ((type*)malloc((cnt) * sizeof(type)))
-#define Calloc(type, cnt)       ((type*)calloc((cnt), sizeof(type)))
-#define Realloc(type, ptr, cnt) ((type*)realloc((ptr), (cnt) * sizeof(type)))
+#define Malloc(type, cnt)       ((type*)hm_malloc((cnt) * sizeof(type)))
+#define Calloc(type, cnt)       ((type*)hm_calloc((cnt), sizeof(type)))
+#define Realloc(type, ptr, cnt) ((type*)hm_realloc((ptr), (cnt) * sizeof(type)))
 
 #define Grow(type, ptr, __i, __m) do { \
 		if ((__i) >= (__m)) { \
@@ -29,28 +39,103 @@ KSEQ_INIT(gzFile, gzread)
 		} \
 	} while (0)
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SEQ_SIMD
+#endif
+
+typedef void (*seq_kernel_f)(int l, unsigned char *s);
+
 unsigned char seq_nt6_table[128];
 void seq_char2nt6(int l, unsigned char *s);
 void seq_revcomp6(int l, unsigned char *s);
+int seq_bench(int64_t len);
 uint32_t SA_checksum(int64_t l, const int *s);
 uint32_t SA_checksum64(int64_t l, const int64_t *s);
+uint32_t SA_checksum40(int64_t l, const uint8_t *s);
+void text2int(const uint8_t *s, int64_t l, int64_t n_sentinels, void *T, int size, int n_threads);
+uint8_t *seq_append(uint8_t *s, int64_t *l, int64_t *max, int64_t len, const uint8_t *t, int pack3);
+int64_t seq_len_fai(const char *fn, int64_t *n_seq);
+int64_t seq_len_scan(const char *fn, int n_threads, int64_t *n_seq);
+int64_t text_alloc_size(int algo, int pack3, int64_t l);
+int64_t sa_alloc_size(int algo, int64_t l);
+void *sa_take(void **pre, int64_t size);
+
+typedef struct { // second stage of pipelined loading
+	int n_threads;
+	void *p[2];
+	int64_t size[2];
+	int64_t done; // bytes prefaulted
+	double t;     // wall-clock time of prefaulting
+} prefault_t;
+
+int prefault_populate(void *p, int64_t size);
+void *prefault_worker(void *data);
+void print_sysinfo(int n_threads);
+int cur_numa_node(void);
+void print_stats(int n, double *rt, double *ct, const int32_t *node);
+void print_prof(double t_run);
+void print_perf(const pev_t *pev, int64_t l);
+void print_numa(int n_pinned);
+void print_layout(const char *name, const void *p, size_t len);
+uint32_t SA_finish64(int64_t l, int64_t **SA, int pack40);
+uint32_t BWT_checksum(int64_t l, const uint8_t *s);
+uint32_t DA_compute64(const uint8_t *s, int64_t *SA, int64_t l);
+uint32_t DA_checksum_gsacak(int64_t l, const int_da *DA);
 long peakrss(void);
 double cputime(void);
 double realtime(void);
 
 int main(int argc, char *argv[])
 {
+	const ko_longopt_t long_options[] = {
+		{ "perf", ko_no_argument, 301 },
+		{ "rss", ko_required_argument, 302 },
+		{ "rss-ms", ko_required_argument, 303 },
+		{ "numa", ko_required_argument, 304 },
+		{ "pin", ko_no_argument, 305 },
+		{ 0, 0, 0 }
+	};
 	ketopt_t o = KETOPT_INIT;
 	kseq_t *seq;
-	gzFile fp;
-	int64_t l = 0, max = 0, n_sentinels = 0;
-	int32_t c, algo = 1, add_rev = 0, n_threads = 1;
-	uint32_t checksum = 0;
-	uint8_t *s = 0;
-	double t_real, t_cpu;
-
-	while ((c = ketopt(&o, argc, argv, 1, "a:rt:", 0)) >= 0) {
+	sio_file_t *fp;
+	int64_t l = 0, max = 0, n_sentinels = 0, text_size;
+	int32_t c, algo = 1, add_rev = 0, n_threads = 1, pack40 = 0, pack3 = 0, with_lcp = 0, with_da = 0, pipelined = 0;
+	int32_t run, n_runs = 1, *node, use_perf = 0, rss_ms = 10, huge = HM_NONE;
+	int32_t numa = NM_NONE, pin = 0, show_numa;
+	const char *fn_rss = 0;
+	pev_t *pev = 0;
+	uint32_t checksum = 0, lcp_checksum = 0, da_checksum = 0;
+	uint8_t *s = 0, *text;
+	void *sa_pre = 0; // SA allocated before reading in the pipelined mode
+	prefault_t pf = {0};
+	pthread_t pf_tid;
+	double t_real, t_cpu, *rt, *ct;
+
+	if (argc >= 2 && strcmp(argv[1], "nt6bench") == 0) // micro-benchmark of nt6 encoding and reverse complement
+		return seq_bench(argc >= 3? atol(argv[2]) * 1048576LL : 0);
+	while ((c = ketopt(&o, argc, argv, 1, "a:rt:PLD3pn:H:", long_options)) >= 0) {
 		if (c == 'r') add_rev = 1;
+		else if (c == 301) use_perf = 1;
+		else if (c == 302) fn_rss = o.arg;
+		else if (c == 303) rss_ms = atoi(o.arg);
+		else if (c == 305) pin = 1;
+		else if (c == 304) {
+			if (strcmp(o.arg, "none") == 0) numa = NM_NONE;
+			else if (strcmp(o.arg, "interleave") == 0) numa = NM_INTERLEAVE;
+			else if (strcmp(o.arg, "touch") == 0) numa = NM_TOUCH;
+			else {
+				fprintf(stderr, "(EE) Unknown NUMA placement.\n");
+				return 1;
+			}
+		}
+		else if (c == 'n') n_runs = atoi(o.arg);
+		else if (c == 'p') pipelined = 1;
+		else if (c == 'H') huge = atoi(o.arg);
+		else if (c == 'P') pack40 = 1;
+		else if (c == '3') pack3 = 1;
+		else if (c == 'L') with_lcp = 1;
+		else if (c == 'D') with_da = 1;
 		else if (c == 't') n_threads = atoi(o.arg);
 		else if (c == 'a') {
 			if (strcmp(o.arg, "ksa64") == 0) algo = 1;
@@ -60,6 +145,9 @@ int main(int argc, char *argv[])
 			else if (strcmp(o.arg, "gsaca-k") == 0) algo = 5;
 			else if (strcmp(o.arg, "sais16x64") == 0) algo = 6;
 			else if (strcmp(o.arg, "sais64-g") == 0) algo = 7;
+			else if (strcmp(o.arg, "sais64-bwt") == 0) algo = 8;
+			else if (strcmp(o.arg, "ksa64-bwt") == 0) algo = 9;
+			else if (strcmp(o.arg, "sais16x64-g") == 0) algo = 10;
 			else {
 				fprintf(stderr, "(EE) Unknown algorithm.\n");
 				return 1;
@@ -68,129 +156,316 @@ int main(int argc, char *argv[])
 	}
 	if (argc == o.ind) {
 		fprintf(stderr, "Usage: mssa-bench [options] input.fasta\n");
+		fprintf(stderr, "       mssa-bench nt6bench [MB]\n");
 		fprintf(stderr, "Options:\n");
-		fprintf(stderr, "  -a STR    algorithm: ksa64, ksa, sais64-g, sais64, sais, sais16x64 or gsaca-k [ksa64]\n");
+		fprintf(stderr, "  -a STR    algorithm: ksa64, ksa, sais64-g, sais64, sais, sais16x64-g, sais16x64, gsaca-k\n"
+		                "            ksa64-bwt or sais64-bwt (BWT only) [ksa64]\n");
 #ifdef LIBSAIS_OPENMP
-		fprintf(stderr, "  -t INT    number of threads for sais [%d]\n", n_threads);
+		fprintf(stderr, "  -t INT    number of threads for sais and ksa [%d]\n", n_threads);
 #endif
 		fprintf(stderr, "  -r        include reverse complement sequences\n");
+		fprintf(stderr, "  -P        pack 64-bit SA to 5 bytes per entry after construction\n");
+		fprintf(stderr, "  -3        pack the text to 3 bits per symbol while reading (ksa64 and ksa only)\n");
+		fprintf(stderr, "  -L        also compute LCP (ksa64, ksa, sais64-g and gsaca-k only)\n");
+		fprintf(stderr, "  -D        also compute the document array (ksa64, ksa, sais64-g and gsaca-k only)\n");
+		fprintf(stderr, "  -p        prefault SA while reading the input (not for stdin)\n");
+		fprintf(stderr, "  -H INT    huge pages for the text, SA and work arrays: 0 for none, 1 for THP, 2 for hugetlbfs\n"
+		                "            (1 GB pages for arrays of 1 GB or more if reserved, otherwise 2 MB) [%d]\n", huge);
+		fprintf(stderr, "  -n INT    construct INT times from the same input and report statistics [%d]\n", n_runs);
+		fprintf(stderr, "  --perf    count cycles, instructions and cache, TLB and branch misses during construction\n");
+		fprintf(stderr, "  --numa STR     placement of the text, SA and work arrays: none, interleave across nodes,\n"
+		                "                 or touch SA and the integer text first by the threads that work on them [none]\n");
+		fprintf(stderr, "  --pin          pin threads to CPUs, spreading them over NUMA nodes\n");
+		fprintf(stderr, "  --rss FILE     write the RSS timeline, tagged by phase, to FILE in CSV\n");
+		fprintf(stderr, "  --rss-ms INT   interval between RSS samples in milliseconds [%d]\n", rss_ms);
+		return 1;
+	}
+	if (n_runs < 1) {
+		fprintf(stderr, "(EE) -n must be positive.\n");
+		return 1;
+	}
+	if (huge < HM_NONE || huge > HM_HUGETLB) {
+		fprintf(stderr, "(EE) -H must be 0, 1 or 2.\n");
+		return 1;
+	}
+	if (pack3 && ((algo != 1 && algo != 2) || with_lcp || with_da)) {
+		fprintf(stderr, "(EE) -3 only works with ksa64 and ksa, without -L or -D.\n");
+		return 1;
+	}
+
+	hm_set_mode(huge);
+	show_numa = nm_init(numa, n_threads, pin) > 1 || numa != NM_NONE || pin;
+	c = nm_pin();
+	if (show_numa) print_numa(c);
+	if (fn_rss && rsslog_start(fn_rss, rss_ms) < 0) {
+		fprintf(stderr, "(EE) Failed to start the RSS sampler.\n");
 		return 1;
 	}
 
+	// size the text to allocate it once; seq_append() still grows it if the size is short, e.g. with a stale .fai
+	rsslog_phase("size");
+	t_real = realtime();
+	t_cpu = cputime();
+	if (strcmp(argv[o.ind], "-") != 0) {
+		int64_t len, n_seq, is_fai = 1;
+		if ((len = seq_len_fai(argv[o.ind], &n_seq)) < 0)
+			len = seq_len_scan(argv[o.ind], n_threads, &n_seq), is_fai = 0;
+		if (len >= 0) {
+			int64_t tot = (len + n_seq) * (add_rev? 2 : 1);
+			max = text_alloc_size(algo, pack3, tot);
+			s = Malloc(uint8_t, max);
+			printf("(MM) Sized text from %s in %.3f sec: %ld symbols; %.3f MB allocated\n", is_fai? ".fai" : "a scan", realtime() - t_real,
+				   (long)tot, max / 1024.0 / 1024.0);
+			if (pipelined && sa_alloc_size(algo, tot) == 0 && nm_policy() == NM_TOUCH) {
+				printf("(MM) --numa touch leaves the text buffer to the construction threads and there is no separate SA; -p is ignored\n");
+			} else if (pipelined && sa_alloc_size(algo, tot) == 0 && !prefault_populate(s, max)) {
+				printf("(MM) MADV_POPULATE_WRITE is not available and there is no separate SA; -p is ignored\n");
+			} else if (pipelined) { // page faults of the text buffer and SA are taken by other threads while reading
+				pf.n_threads = n_threads;
+				if (nm_policy() != NM_TOUCH) // with NM_TOUCH, the buffer is left to the threads that write it; see nm_touch() calls below
+					pf.p[0] = s, pf.size[0] = max;
+				if ((pf.size[1] = sa_alloc_size(algo, tot)) > 0)
+					pf.p[1] = sa_pre = Malloc(uint8_t, pf.size[1]);
+				pthread_create(&pf_tid, 0, prefault_worker, &pf);
+			}
+		}
+	}
+
 	// read FASTA/Q
+	rsslog_phase("read");
 	t_real = realtime();
 	t_cpu = cputime();
-	fp = gzopen(argv[o.ind], "r");
+	if ((fp = sio_open(argv[o.ind], n_threads)) == 0) {
+		fprintf(stderr, "(EE) Failed to open file '%s'.\n", argv[o.ind]);
+		return 1;
+	}
 	seq = kseq_init(fp);
 	while (kseq_read(seq) >= 0) {
-		Grow(uint8_t, s, l + (seq->seq.l + 2), max); // +2 to leave room for gSACA-K
 		seq_char2nt6(seq->seq.l, (uint8_t*)seq->seq.s);
-		memcpy(s + l, seq->seq.s, seq->seq.l + 1); // NB: we are copying 0
-		l += seq->seq.l + 1;
+		s = seq_append(s, &l, &max, seq->seq.l, (uint8_t*)seq->seq.s, pack3);
 		++n_sentinels;
 		if (add_rev) {
-			Grow(uint8_t, s, l + (seq->seq.l + 2), max);
 			seq_revcomp6(seq->seq.l, (uint8_t*)seq->seq.s);
-			memcpy(s + l, seq->seq.s, seq->seq.l + 1);
-			l += seq->seq.l + 1;
+			s = seq_append(s, &l, &max, seq->seq.l, (uint8_t*)seq->seq.s, pack3);
 			++n_sentinels;
 		}
 	}
 	kseq_destroy(seq);
-	gzclose(fp);
-	printf("(MM) Read file in %.3f*%.3f sec (Peak RSS: %.3f MB)\n", realtime() - t_real, (cputime() - t_cpu) / (realtime() - t_real), peakrss() / 1024.0 / 1024.0);
+	if (sio_error(fp)) {
+		fprintf(stderr, "(EE) Failed to read file '%s'.\n", argv[o.ind]);
+		return 1;
+	}
+	c = sio_mode(fp);
+	sio_close(fp);
+	if (pf.n_threads > 0) pthread_join(pf_tid, 0);
+	printf("(MM) Read file in %.3f*%.3f sec (Peak RSS: %.3f MB; %s)\n", realtime() - t_real, (cputime() - t_cpu) / (realtime() - t_real), peakrss() / 1024.0 / 1024.0,
+		   c == SIO_BGZF? "parallel BGZF" : c == SIO_MMAP? "mmap" : "zlib stream");
+	if (pf.n_threads > 0)
+		printf("(MM) Prefaulted %.3f of %.3f MB in %.3f sec while reading\n", pf.done / 1024.0 / 1024.0, (pf.size[0] + pf.size[1]) / 1024.0 / 1024.0, pf.t);
+	if (show_numa) print_layout("the text", s, max);
 
-	t_real = realtime();
-	t_cpu = cputime();
-	if (algo == 1) { // ksa64
-		int64_t *SA = Malloc(int64_t, l);
-		ksa_sa64(s, SA, l, 6);
-		checksum = SA_checksum64(l, SA);
-		free(SA); free(s);
-	} else if (algo == 2) { // ksa
-		int32_t *SA = Malloc(int32_t, l);
-		ksa_sa32(s, SA, l, 6);
-		checksum = SA_checksum(l, SA);
-		free(SA); free(s);
-	} else if (algo == 3) { // libsais64
-		int64_t i, k = 0, *tmp = Malloc(int64_t, l);
-		for (i = 0; i < l; ++i)
-			tmp[i] = s[i]? n_sentinels + s[i] : ++k;
-		free(s);
-		int64_t *SA = Malloc(int64_t, l + 10000);
-#ifdef LIBSAIS_OPENMP
-		if (n_threads > 1) {
-			libsais64_long_omp(tmp, SA, l, n_sentinels + 6, 10000, n_threads);
-		} else {
-			libsais64_long(tmp, SA, l, n_sentinels + 6, 10000);
+	rt = Calloc(double, n_runs), ct = Calloc(double, n_runs), node = Calloc(int32_t, n_runs);
+	if (n_runs > 1) print_sysinfo(n_threads);
+	if (use_perf && (pev = pev_open(n_threads)) == 0)
+		printf("(MM) Hardware counters are not available; --perf is ignored\n");
+	text = s, text_size = pack3? ksa_p3_size(l) : l + 1; // +1 for gSACA-K
+	for (run = 0; run < n_runs; ++run) {
+		if (n_runs > 1) { // a fresh buffer of the same capacity for each run; the loaded text is kept
+			rsslog_phase("copy");
+			s = Malloc(uint8_t, max > text_size? max : text_size);
+			memcpy(s, text, text_size);
 		}
+		node[run] = cur_numa_node();
+		saprof_reset();
+		rsslog_phase("construct");
+		if (pev) pev_start(pev);
+		t_real = realtime();
+		t_cpu = cputime();
+		if (algo == 1) { // ksa64
+			int64_t *SA = (int64_t*)sa_take(&sa_pre, l * sizeof(int64_t));
+			if (with_lcp) {
+				int64_t *LCP = Malloc(int64_t, l);
+				ksa_sa_lcp64(s, SA, LCP, l, 6, n_threads);
+				lcp_checksum = SA_checksum64(l, LCP);
+				hm_free(LCP);
+			} else if (pack3) ksa_sa64_p3(s, SA, l, 6, n_threads);
+			else if (n_threads > 1) ksa_sa64_omp(s, SA, l, 6, n_threads);
+			else ksa_sa64(s, SA, l, 6);
+			if (with_da) da_checksum = DA_compute64(s, SA, l);
+			checksum = SA_finish64(l, &SA, pack40);
+			hm_free(SA); hm_free(s);
+		} else if (algo == 2) { // ksa
+			int32_t *SA = (int32_t*)sa_take(&sa_pre, l * sizeof(int32_t));
+			if (with_lcp) {
+				int32_t *LCP = Malloc(int32_t, l);
+				ksa_sa_lcp32(s, SA, LCP, l, 6, n_threads);
+				lcp_checksum = SA_checksum(l, LCP);
+				hm_free(LCP);
+			} else if (pack3) ksa_sa32_p3(s, SA, l, 6, n_threads);
+			else if (n_threads > 1) ksa_sa32_omp(s, SA, l, 6, n_threads);
+			else ksa_sa32(s, SA, l, 6);
+			if (with_da) {
+				int32_t *DA = Malloc(int32_t, l);
+				ksa_da32(s, SA, DA, l);
+				da_checksum = SA_checksum(l, DA);
+				hm_free(DA);
+			}
+			checksum = SA_checksum(l, SA);
+			hm_free(SA); hm_free(s);
+		} else if (algo == 3) { // libsais64; the integer text is built in place after SA[0..l+9999]
+			int64_t *SA = (int64_t*)Realloc(uint8_t, s, (2 * l + 10000) * sizeof(int64_t)), *tmp = SA + l + 10000;
+			nm_touch(SA, (l + 10000) * sizeof(*SA), l + 2); // the text is in the first l + 2 bytes
+			nm_touch(tmp, l * sizeof(*tmp), 0);
+			text2int((uint8_t*)SA, l, n_sentinels, tmp, sizeof(*tmp), n_threads);
+#ifdef LIBSAIS_OPENMP
+			if (n_threads > 1) {
+				libsais64_long_omp(tmp, SA, l, n_sentinels + 6, 10000, n_threads);
+			} else {
+				libsais64_long(tmp, SA, l, n_sentinels + 6, 10000);
+			}
 #else
-		libsais64_long(tmp, SA, l, n_sentinels + 6, 10000);
+			libsais64_long(tmp, SA, l, n_sentinels + 6, 10000);
 #endif
-		checksum = SA_checksum64(l, SA);
-		free(SA); free(tmp);
-	} else if (algo == 4) { // libsais
-		int32_t i, k = 0, *tmp = Malloc(int32_t, l);
-		for (i = 0; i < l; ++i)
-			tmp[i] = s[i]? n_sentinels + s[i] : ++k;
-		free(s);
-		int32_t *SA = Malloc(int32_t, l + 10000);
+			checksum = SA_finish64(l, &SA, pack40);
+			hm_free(SA);
+		} else if (algo == 4) { // libsais
+			int32_t *SA = (int32_t*)Realloc(uint8_t, s, (2 * l + 10000) * sizeof(int32_t)), *tmp = SA + l + 10000;
+			nm_touch(SA, (l + 10000) * sizeof(*SA), l + 2); // the text is in the first l + 2 bytes
+			nm_touch(tmp, l * sizeof(*tmp), 0);
+			text2int((uint8_t*)SA, l, n_sentinels, tmp, sizeof(*tmp), n_threads);
 #ifdef LIBSAIS_OPENMP
-		if (n_threads > 1) {
-			libsais_int_omp(tmp, SA, l, n_sentinels + 6, 10000, n_threads);
-		} else {
-			libsais_int(tmp, SA, l, n_sentinels + 6, 10000);
-		}
+			if (n_threads > 1) {
+				libsais_int_omp(tmp, SA, l, n_sentinels + 6, 10000, n_threads);
+			} else {
+				libsais_int(tmp, SA, l, n_sentinels + 6, 10000);
+			}
 #else
-		libsais_int(tmp, SA, l, n_sentinels + 6, 10000);
+			libsais_int(tmp, SA, l, n_sentinels + 6, 10000);
 #endif
-		checksum = SA_checksum(l, SA);
-		free(SA); free(tmp);
-	} else if (algo == 6) { // libsais16x64
-		int64_t i, k = 0;
-		assert(n_sentinels + 6 < UINT16_MAX);
-		uint16_t *tmp = Malloc(uint16_t, l);
-		for (i = 0; i < l; ++i)
-			tmp[i] = s[i]? n_sentinels + s[i] : ++k;
-		free(s);
-		int64_t *SA = Malloc(int64_t, l + 10000);
+			checksum = SA_checksum(l, SA);
+			hm_free(SA);
+		} else if (algo == 6) { // libsais16x64
+			if (n_sentinels + 6 >= UINT16_MAX) {
+				fprintf(stderr, "(EE) sais16x64 supports up to %d sequences; use sais16x64-g instead.\n", UINT16_MAX - 7);
+				return 1;
+			}
+			int64_t *SA = (int64_t*)Realloc(uint8_t, s, (l + 10000) * sizeof(int64_t) + l * sizeof(uint16_t));
+			uint16_t *tmp = (uint16_t*)(SA + l + 10000);
+			nm_touch(SA, (l + 10000) * sizeof(*SA), l + 2); // the text is in the first l + 2 bytes
+			nm_touch(tmp, l * sizeof(*tmp), 0);
+			text2int((uint8_t*)SA, l, n_sentinels, tmp, sizeof(*tmp), n_threads);
 #ifdef LIBSAIS_OPENMP
-		if (n_threads > 1) {
-			libsais16x64_omp(tmp, SA, l, 10000, 0, n_threads);
-		} else {
+			if (n_threads > 1) {
+				libsais16x64_omp(tmp, SA, l, 10000, 0, n_threads);
+			} else {
+				libsais16x64(tmp, SA, l, 10000, 0);
+			}
+#else
 			libsais16x64(tmp, SA, l, 10000, 0);
-		}
+#endif
+			checksum = SA_finish64(l, &SA, pack40);
+			hm_free(SA);
+		} else if (algo == 10) { // libsais16x64 gsa; sentinels are all 0 and the 16-bit text is built in place after SA[0..l+9999]
+			int64_t *SA = (int64_t*)Realloc(uint8_t, s, (l + 10000) * sizeof(int64_t) + l * sizeof(uint16_t));
+			uint16_t *tmp = (uint16_t*)(SA + l + 10000);
+			nm_touch(SA, (l + 10000) * sizeof(*SA), l + 2); // the text is in the first l + 2 bytes
+			nm_touch(tmp, l * sizeof(*tmp), 0);
+			text2int((uint8_t*)SA, l, -1, tmp, sizeof(*tmp), n_threads);
+#ifdef LIBSAIS_OPENMP
+			if (n_threads > 1) {
+				libsais16x64_gsa_omp(tmp, SA, l, 10000, 0, n_threads);
+			} else {
+				libsais16x64_gsa(tmp, SA, l, 10000, 0);
+			}
 #else
-		libsais16x64(tmp, SA, l, 10000, 0);
+			libsais16x64_gsa(tmp, SA, l, 10000, 0);
 #endif
-		checksum = SA_checksum64(l, SA);
-		free(SA); free(tmp);
-	} else if (algo == 7) { // libsais64 gsa
-		int64_t *SA = Malloc(int64_t, l + 10000);
+			checksum = SA_finish64(l, &SA, pack40);
+			hm_free(SA);
+		} else if (algo == 7) { // libsais64 gsa
+			int64_t *SA = (int64_t*)sa_take(&sa_pre, (l + 10000) * sizeof(int64_t));
 #ifdef LIBSAIS_OPENMP
-		if (n_threads > 1) {
-			libsais64_gsa_omp(s, SA, l, 10000, 0, n_threads);
-		} else {
+			if (n_threads > 1) {
+				libsais64_gsa_omp(s, SA, l, 10000, 0, n_threads);
+			} else {
+				libsais64_gsa(s, SA, l, 10000, 0);
+			}
+#else
 			libsais64_gsa(s, SA, l, 10000, 0);
-		}
+#endif
+			if (with_lcp) {
+				int64_t *PLCP = Malloc(int64_t, l), *LCP = Malloc(int64_t, l);
+#ifdef LIBSAIS_OPENMP
+				libsais64_plcp_gsa_omp(s, SA, PLCP, l, n_threads);
+				libsais64_lcp_omp(PLCP, SA, LCP, l, n_threads);
 #else
-		libsais64_gsa(s, SA, l, 10000, 0);
+				libsais64_plcp_gsa(s, SA, PLCP, l);
+				libsais64_lcp(PLCP, SA, LCP, l);
 #endif
-		checksum = SA_checksum64(l, SA);
-		free(SA); free(s);
-	} else if (algo == 5) { // gSACA-K
-		uint_t *SA = Malloc(uint_t, l + 1);
-		int64_t i;
-		for (i = 0; i < l; ++i) ++s[i];
-		s[l] = 0;
-		gsacak(s, SA, 0, 0, l + 1);
-		checksum = sizeof(uint_t) == 8? SA_checksum64(l, (int64_t*)SA + 1) : SA_checksum(l, (int32_t*)SA + 1);
-		free(SA); free(s);
-	} else {
-		fprintf(stderr, "(EE) unknown algorithms\n");
-		return 1;
+				hm_free(PLCP);
+				lcp_checksum = SA_checksum64(l, LCP);
+				hm_free(LCP);
+			}
+			if (with_da) da_checksum = DA_compute64(s, SA, l);
+			checksum = SA_finish64(l, &SA, pack40);
+			hm_free(SA); hm_free(s);
+		} else if (algo == 8) { // libsais64 gsa_bwt
+			int64_t *A = (int64_t*)sa_take(&sa_pre, (l + 10000) * sizeof(int64_t));
+#ifdef LIBSAIS_OPENMP
+			if (n_threads > 1) {
+				libsais64_gsa_bwt_omp(s, s, A, l, 10000, 0, 0, n_threads);
+			} else {
+				libsais64_gsa_bwt(s, s, A, l, 10000, 0, 0);
+			}
+#else
+			libsais64_gsa_bwt(s, s, A, l, 10000, 0, 0);
+#endif
+			hm_free(A);
+			checksum = BWT_checksum(l, s);
+			hm_free(s);
+		} else if (algo == 9) { // ksa64 bwt
+			int64_t *SA = (int64_t*)sa_take(&sa_pre, l * sizeof(int64_t));
+			ksa_bwt64(s, s, SA, l, 6, 0);
+			hm_free(SA);
+			checksum = BWT_checksum(l, s);
+			hm_free(s);
+		} else if (algo == 5) { // gSACA-K
+			uint_t *SA = (uint_t*)sa_take(&sa_pre, (l + 1) * sizeof(uint_t));
+			int64_t i;
+			for (i = 0; i < l; ++i) ++s[i];
+			s[l] = 0;
+			int_t *LCP = with_lcp? Malloc(int_t, l + 1) : 0;
+			int_da *DA = with_da? Malloc(int_da, l + 1) : 0;
+			gsacak(s, SA, LCP, DA, l + 1);
+			if (LCP) lcp_checksum = sizeof(int_t) == 8? SA_checksum64(l, (int64_t*)LCP + 1) : SA_checksum(l, (int32_t*)LCP + 1);
+			if (DA) da_checksum = DA_checksum_gsacak(l, DA + 1);
+			hm_free(LCP); hm_free(DA);
+			checksum = sizeof(uint_t) == 8? SA_checksum64(l, (int64_t*)SA + 1) : SA_checksum(l, (int32_t*)SA + 1);
+			hm_free(SA); hm_free(s);
+		} else {
+			fprintf(stderr, "(EE) unknown algorithms\n");
+			return 1;
+		}
+		rt[run] = realtime() - t_real, ct[run] = cputime() - t_cpu;
+		if (pev) pev_stop(pev);
+		printf("(MM) Generated %s in %.3f*%.3f sec (Peak RSS: %.3f MB; checksum: %x)\n", algo == 8 || algo == 9? "BWT" : with_lcp && with_da? "SA+LCP+DA" : with_lcp? "SA+LCP" : with_da? "SA+DA" : "SA", rt[run], ct[run] / rt[run], peakrss() / 1024.0 / 1024.0, checksum);
+		if (with_lcp) printf("(MM) LCP checksum: %x\n", lcp_checksum);
+		if (with_da) printf("(MM) DA checksum: %x\n", da_checksum);
+		print_prof(rt[run]);
+		if (pev) print_perf(pev, l);
+		if (huge) {
+			size_t tlb, thp, anon;
+			hm_peak(&tlb, &thp, &anon);
+			printf("(MM) Huge pages: %.3f MB from hugetlbfs; %.3f MB advised for THP, of which %.3f MB backed\n", tlb / 1024.0 / 1024.0,
+				   thp / 1024.0 / 1024.0, anon / 1024.0 / 1024.0);
+		}
+		if (show_numa) print_layout("the largest array", 0, 0);
 	}
-	printf("(MM) Generated SA in %.3f*%.3f sec (Peak RSS: %.3f MB; checksum: %x)\n", realtime() - t_real, (cputime() - t_cpu) / (realtime() - t_real), peakrss() / 1024.0 / 1024.0, checksum);
+	if (n_runs > 1) print_stats(n_runs, rt, ct, node);
+	if (n_runs > 1) hm_free(text);
+	pev_close(pev);
+	hm_free(rt); hm_free(ct); hm_free(node);
+	rsslog_stop();
 	return 0;
 }
 
@@ -205,14 +480,14 @@ unsigned char seq_nt6_table[128] = {
     5, 5, 5, 5,  4, 5, 5, 5,  5, 5, 5, 5,  5, 5, 5, 5
 };
 
-void seq_char2nt6(int l, unsigned char *s)
+static void seq_char2nt6_scalar(int l, unsigned char *s)
 {
 	int i;
 	for (i = 0; i < l; ++i)
 		s[i] = s[i] < 128? seq_nt6_table[s[i]] : 5;
 }
 
-void seq_revcomp6(int l, unsigned char *s)
+static void seq_revcomp6_scalar(int l, unsigned char *s)
 {
 	int i;
 	for (i = 0; i < l>>1; ++i) {
@@ -224,12 +499,358 @@ void seq_revcomp6(int l, unsigned char *s)
 	if (l&1) s[i] = (s[i] >= 1 && s[i] <= 4)? 5 - s[i] : s[i];
 }
 
+#ifdef SEQ_SIMD
+/* nt6 encoding with nibble lookups: the low nibble of A/C/G/T is 1/3/7/4 and
+ * the high nibble is 4 or 6 for A/C/G and 5 or 7 for T, regardless of case. A
+ * byte is a nucleotide iff the classes of its two nibbles match. */
+#define NT6_LO_CLASS   -1, 1,-1, 1,  2,-1,-1, 1, -1,-1,-1,-1, -1,-1,-1,-1
+#define NT6_HI_CLASS    0, 0, 0, 0,  1, 2, 1, 2,  0, 0, 0, 0,  0, 0, 0, 0
+#define NT6_CODE        5, 1, 5, 2,  4, 5, 5, 3,  5, 5, 5, 5,  5, 5, 5, 5
+#define NT6_COMP        0, 4, 3, 2,  1, 5, 6, 7,  8, 9,10,11, 12,13,14,15
+#define NT6_REV        15,14,13,12, 11,10, 9, 8,  7, 6, 5, 4,  3, 2, 1, 0
+
+__attribute__((target("sse4.1")))
+static void seq_char2nt6_sse41(int l, unsigned char *s)
+{
+	const __m128i lo_cls = _mm_setr_epi8(NT6_LO_CLASS), hi_cls = _mm_setr_epi8(NT6_HI_CLASS), code = _mm_setr_epi8(NT6_CODE);
+	const __m128i m4 = _mm_set1_epi8(0x0f), five = _mm_set1_epi8(5), zero = _mm_setzero_si128();
+	int i;
+	for (i = 0; i + 16 <= l; i += 16) {
+		__m128i x = _mm_loadu_si128((__m128i*)(s + i));
+		__m128i lo = _mm_and_si128(x, m4), hi = _mm_and_si128(_mm_srli_epi16(x, 4), m4);
+		__m128i ok = _mm_cmpeq_epi8(_mm_shuffle_epi8(lo_cls, lo), _mm_shuffle_epi8(hi_cls, hi));
+		__m128i y = _mm_blendv_epi8(five, _mm_shuffle_epi8(code, lo), ok);
+		_mm_storeu_si128((__m128i*)(s + i), _mm_andnot_si128(_mm_cmpeq_epi8(x, zero), y)); // keep 0 as 0
+	}
+	seq_char2nt6_scalar(l - i, s + i);
+}
+
+__attribute__((target("avx2")))
+static void seq_char2nt6_avx2(int l, unsigned char *s)
+{
+	const __m256i lo_cls = _mm256_setr_epi8(NT6_LO_CLASS, NT6_LO_CLASS), hi_cls = _mm256_setr_epi8(NT6_HI_CLASS, NT6_HI_CLASS);
+	const __m256i code = _mm256_setr_epi8(NT6_CODE, NT6_CODE);
+	const __m256i m4 = _mm256_set1_epi8(0x0f), five = _mm256_set1_epi8(5), zero = _mm256_setzero_si256();
+	int i;
+	for (i = 0; i + 32 <= l; i += 32) {
+		__m256i x = _mm256_loadu_si256((__m256i*)(s + i));
+		__m256i lo = _mm256_and_si256(x, m4), hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), m4);
+		__m256i ok = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(lo_cls, lo), _mm256_shuffle_epi8(hi_cls, hi));
+		__m256i y = _mm256_blendv_epi8(five, _mm256_shuffle_epi8(code, lo), ok);
+		_mm256_storeu_si256((__m256i*)(s + i), _mm256_andnot_si256(_mm256_cmpeq_epi8(x, zero), y));
+	}
+	seq_char2nt6_sse41(l - i, s + i);
+}
+
+/* Reverse complement by swapping blocks from both ends; the middle is left to the scalar version */
+__attribute__((target("sse4.1")))
+static void seq_revcomp6_sse41(int l, unsigned char *s)
+{
+	const __m128i comp = _mm_setr_epi8(NT6_COMP), rev = _mm_setr_epi8(NT6_REV);
+	int i;
+	for (i = 0; 2 * i + 32 <= l; i += 16) {
+		__m128i a = _mm_loadu_si128((__m128i*)(s + i)), b = _mm_loadu_si128((__m128i*)(s + l - i - 16));
+		_mm_storeu_si128((__m128i*)(s + i), _mm_shuffle_epi8(_mm_shuffle_epi8(comp, b), rev));
+		_mm_storeu_si128((__m128i*)(s + l - i - 16), _mm_shuffle_epi8(_mm_shuffle_epi8(comp, a), rev));
+	}
+	seq_revcomp6_scalar(l - 2 * i, s + i);
+}
+
+__attribute__((target("avx2")))
+static void seq_revcomp6_avx2(int l, unsigned char *s)
+{
+	const __m256i comp = _mm256_setr_epi8(NT6_COMP, NT6_COMP), rev = _mm256_setr_epi8(NT6_REV, NT6_REV);
+	int i;
+	for (i = 0; 2 * i + 64 <= l; i += 32) {
+		__m256i a = _mm256_loadu_si256((__m256i*)(s + i)), b = _mm256_loadu_si256((__m256i*)(s + l - i - 32));
+		a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_shuffle_epi8(comp, a), rev), 0x4e); // swap 128-bit lanes
+		b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_shuffle_epi8(comp, b), rev), 0x4e);
+		_mm256_storeu_si256((__m256i*)(s + i), b);
+		_mm256_storeu_si256((__m256i*)(s + l - i - 32), a);
+	}
+	seq_revcomp6_sse41(l - 2 * i, s + i);
+}
+#endif
+
+/** Fastest kernel supported by the CPU; level is 0 for scalar, 1 for SSE4.1 and 2 for AVX2 */
+static int seq_simd_level(void)
+{
+#ifdef SEQ_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return 2;
+	if (__builtin_cpu_supports("sse4.1")) return 1;
+#endif
+	return 0;
+}
+
+static seq_kernel_f seq_kernel(int is_rev, int level)
+{
+#ifdef SEQ_SIMD
+	if (level >= 2) return is_rev? seq_revcomp6_avx2 : seq_char2nt6_avx2;
+	if (level == 1) return is_rev? seq_revcomp6_sse41 : seq_char2nt6_sse41;
+#endif
+	return is_rev? seq_revcomp6_scalar : seq_char2nt6_scalar;
+}
+
+void seq_char2nt6(int l, unsigned char *s)
+{
+	static seq_kernel_f f = 0;
+	if (f == 0) f = seq_kernel(0, seq_simd_level());
+	f(l, s);
+}
+
+void seq_revcomp6(int l, unsigned char *s) // s is nt6 encoded
+{
+	static seq_kernel_f f = 0;
+	if (f == 0) f = seq_kernel(1, seq_simd_level());
+	f(l, s);
+}
+
+/** Measure the throughput of each nt6 kernel on len random bytes; check the result against the scalar version */
+int seq_bench(int64_t len)
+{
+	static const char *name[] = { "scalar", "sse4.1", "avx2" };
+	const char *alpha = "ACGTACGTACGTacgtNnRYX-*";
+	int level, max_level = seq_simd_level(), is_rev, i, n_rep = 5, ret = 0;
+	unsigned char *src, *ref, *buf;
+	if (len <= 0 || len > INT32_MAX) len = 1<<28;
+	src = Malloc(unsigned char, len), ref = Malloc(unsigned char, len), buf = Malloc(unsigned char, len);
+	srand(11);
+	for (i = 0; i < len; ++i) src[i] = alpha[rand() % 23];
+	for (is_rev = 0; is_rev < 2; ++is_rev) {
+		memcpy(ref, src, len);
+		if (is_rev) seq_char2nt6_scalar(len, ref), seq_revcomp6_scalar(len, ref);
+		else seq_char2nt6_scalar(len, ref);
+		for (level = 0; level <= max_level; ++level) {
+			seq_kernel_f f = seq_kernel(is_rev, level);
+			double t, best = 1e30;
+			for (i = 0; i < n_rep; ++i) {
+				memcpy(buf, src, len);
+				if (is_rev) seq_char2nt6_scalar(len, buf);
+				t = realtime();
+				f(len, buf);
+				t = realtime() - t;
+				best = best < t? best : t;
+			}
+			if (memcmp(buf, ref, len) != 0) ret = 1;
+			printf("(MM) %s %s: %.3f GB/s%s\n", is_rev? "revcomp6" : "char2nt6", name[level], len / best * 1e-9, memcmp(buf, ref, len)? " (MISMATCH)" : "");
+		}
+	}
+	hm_free(src); hm_free(ref); hm_free(buf);
+	return ret;
+}
+
+/**
+ * Convert the nt6 text to integers with T[i] = s[i]? n_sentinels+s[i] : rank of the sentinel
+ *
+ * The rank of the first sentinel in each chunk is computed with a prefix scan
+ * over per-chunk counts, so chunks are converted in parallel. T, of "size"
+ * bytes per element, must not overlap s. If n_sentinels is negative, s is
+ * only widened, keeping all sentinels 0 as the generalized SA takes them.
+ */
+void text2int(const uint8_t *s, int64_t l, int64_t n_sentinels, void *T, int size, int n_threads)
+{
+	int64_t c, n_chunks = n_threads > 1? n_threads : 1, *r = Calloc(int64_t, n_chunks + 1);
+	const char *ph = rsslog_phase("convert");
+#ifdef LIBSAIS_OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static, 1) if(n_sentinels >= 0)
+#endif
+	for (c = 0; c < n_chunks; ++c) {
+		int64_t i, e = l * (c + 1) / n_chunks;
+		if (n_sentinels < 0) continue;
+		for (i = l * c / n_chunks; i < e; ++i) r[c + 1] += (s[i] == 0);
+	}
+	for (c = 1; c <= n_chunks; ++c) r[c] += r[c - 1];
+#ifdef LIBSAIS_OPENMP
+	#pragma omp parallel for num_threads(n_threads) schedule(static, 1)
+#endif
+	for (c = 0; c < n_chunks; ++c) {
+		int64_t i, k = r[c], e = l * (c + 1) / n_chunks;
+		for (i = l * c / n_chunks; i < e; ++i) {
+			int64_t x = n_sentinels < 0? s[i] : s[i]? n_sentinels + s[i] : ++k;
+			if (size == 8) ((int64_t*)T)[i] = x;
+			else if (size == 4) ((int32_t*)T)[i] = x;
+			else ((uint16_t*)T)[i] = x;
+		}
+	}
+	hm_free(r);
+	rsslog_phase(ph);
+}
+
+uint8_t *seq_append(uint8_t *s, int64_t *l, int64_t *max, int64_t len, const uint8_t *t, int pack3)
+{
+	int64_t i;
+	if (pack3) {
+		Grow(uint8_t, s, ksa_p3_size(*l + len + 1), *max);
+		for (i = 0; i <= len; ++i) // NB: t[len] is 0
+			ksa_set3(s, *l + i, t[i]);
+	} else {
+		Grow(uint8_t, s, *l + (len + 2), *max); // +2 to leave room for gSACA-K
+		memcpy(s + *l, t, len + 1); // NB: we are copying 0
+	}
+	*l += len + 1;
+	return s;
+}
+
+/** Total sequence length in the .fai index of fn, or -1 if there is no index */
+int64_t seq_len_fai(const char *fn, int64_t *n_seq)
+{
+	char *fn_fai, buf[4096];
+	int64_t len = 0;
+	FILE *fp;
+	fn_fai = Malloc(char, strlen(fn) + 5);
+	strcat(strcpy(fn_fai, fn), ".fai");
+	fp = fopen(fn_fai, "r");
+	hm_free(fn_fai);
+	if (fp == 0) return -1;
+	*n_seq = 0;
+	while (fgets(buf, sizeof(buf), fp)) { // NAME <TAB> LENGTH <TAB> ...
+		char *p = strchr(buf, '\t');
+		if (p == 0) { len = -1; break; }
+		len += strtoll(p + 1, 0, 10), ++*n_seq;
+	}
+	fclose(fp);
+	return len;
+}
+
+/** Total sequence length by a scan that doesn't store sequences; this counts the same symbols as kseq_read() */
+int64_t seq_len_scan(const char *fn, int n_threads, int64_t *n_seq)
+{
+	int64_t len = 0, rec = 0; // rec: length of the current sequence
+	int n, i, last = 0, state = 0; // state 0: at the start of a line; 1: in a header; 2: in a sequence line
+	uint8_t *buf;
+	sio_file_t *fp;
+	if ((fp = sio_open(fn, n_threads)) == 0) return -1;
+	buf = Malloc(uint8_t, 1<<20);
+	*n_seq = 0;
+	while ((n = sio_read(fp, buf, 1<<20)) > 0) {
+		for (i = 0; i < n; ++i) {
+			int c = buf[i];
+			if (state == 0) {
+				if (c == '>') state = 1, ++*n_seq, len += rec, rec = 0;
+				else if (c == '@' || c == '+') break; // FASTQ
+				else if (c != '\n') state = 2, ++rec;
+			} else if (c == '\n') {
+				if (state == 2 && last == '\r' && rec > 1) --rec; // kseq trims '\r' this way
+				state = 0;
+			} else if (state == 2) ++rec;
+			last = c;
+		}
+		if (i < n) break;
+	}
+	len += rec;
+	hm_free(buf);
+	if (n > 0) { // FASTQ: let kseq parse it, as '@' and '+' may start quality lines
+		kseq_t *seq;
+		sio_close(fp);
+		if ((fp = sio_open(fn, n_threads)) == 0) return -1;
+		seq = kseq_init(fp);
+		for (len = 0, *n_seq = 0; kseq_read(seq) >= 0; ++*n_seq)
+			len += seq->seq.l;
+		kseq_destroy(seq);
+	}
+	if (n < 0 || sio_error(fp)) len = -1;
+	sio_close(fp);
+	return len;
+}
+
+/** Bytes for the text of l symbols, plus the room for the integer text if algo builds it in place of the 8-bit text */
+int64_t text_alloc_size(int algo, int pack3, int64_t l)
+{
+	int64_t size = pack3? ksa_p3_size(l) + 1 : l + 2; // match the slack requested by seq_append(); +2 for gSACA-K
+	int64_t fs = algo == 3? (2 * l + 10000) * sizeof(int64_t) : algo == 4? (2 * l + 10000) * sizeof(int32_t)
+		: algo == 6 || algo == 10? (l + 10000) * sizeof(int64_t) + l * sizeof(uint16_t) : 0;
+	return size > fs? size : fs;
+}
+
+/** Bytes of the SA allocated separately from the text; 0 if SA is built in the text buffer */
+int64_t sa_alloc_size(int algo, int64_t l)
+{
+	if (algo == 1 || algo == 9) return l * sizeof(int64_t);
+	if (algo == 2) return l * sizeof(int32_t);
+	if (algo == 7 || algo == 8) return (l + 10000) * sizeof(int64_t);
+	if (algo == 5) return (l + 1) * sizeof(uint_t);
+	return 0;
+}
+
+/** Hand over the SA allocated before reading, resized to size bytes, or allocate a new one; first touched for NM_TOUCH */
+void *sa_take(void **pre, int64_t size)
+{
+	void *p = *pre? hm_realloc(*pre, size) : hm_malloc(size);
+	*pre = 0;
+	nm_touch(p, size, 0);
+	return p;
+}
+
+/** Whether MADV_POPULATE_WRITE works here, tried on the first whole page of [p, p+size) */
+int prefault_populate(void *p, int64_t size)
+{
+#ifdef MADV_POPULATE_WRITE
+	int64_t pg = sysconf(_SC_PAGESIZE);
+	intptr_t st = ((intptr_t)p + pg - 1) / pg * pg;
+	return st + pg <= (intptr_t)p + size && madvise((void*)st, pg, MADV_POPULATE_WRITE) == 0;
+#else
+	(void)p, (void)size;
+	return 0;
+#endif
+}
+
+/**
+ * Prefault the text buffer and SA with n_threads threads while the main thread reads
+ *
+ * MADV_POPULATE_WRITE maps pages without changing their content, so this is
+ * safe on the part of the text that is being written. If seq_append() moves
+ * the text buffer, madvise() fails on the unmapped range and does no harm.
+ * Without MADV_POPULATE_WRITE, e.g. before Linux 5.14, only SA is prefaulted,
+ * by writing a byte to each page; SA holds no data yet. pf->done counts the
+ * bytes that were actually prefaulted. With NM_TOUCH, SA is touched with
+ * nm_touch(), so its pages land where the construction threads will use them.
+ */
+void *prefault_worker(void *data)
+{
+	prefault_t *pf = (prefault_t*)data;
+	int64_t i, pg = sysconf(_SC_PAGESIZE), n_blk = pf->n_threads * 16, done = 0;
+	double t = realtime();
+	nm_pin(); // this thread has its own OpenMP pool
+	if (nm_policy() == NM_TOUCH) {
+		if (pf->p[1]) nm_touch(pf->p[1], pf->size[1], 0), done = pf->size[1];
+		n_blk = 0;
+	}
+#ifdef LIBSAIS_OPENMP
+	#pragma omp parallel for num_threads(pf->n_threads) schedule(dynamic, 1) reduction(+:done)
+#endif
+	for (i = 0; i < 2 * n_blk; ++i) {
+		int64_t r = i / n_blk, j = i % n_blk, st, en;
+		if (pf->p[r] == 0) continue;
+		st = ((intptr_t)pf->p[r] + pf->size[r] * j / n_blk + pg - 1) / pg * pg; // page-aligned [st, en)
+		en = ((intptr_t)pf->p[r] + pf->size[r] * (j + 1) / n_blk + pg - 1) / pg * pg;
+		if (j == n_blk - 1) en = ((intptr_t)pf->p[r] + pf->size[r]) / pg * pg;
+		if (st >= en) continue;
+#ifdef MADV_POPULATE_WRITE
+		if (madvise((void*)st, en - st, MADV_POPULATE_WRITE) == 0) {
+			done += en - st;
+			continue;
+		}
+#endif
+		if (r == 1) {
+			volatile uint8_t *q;
+			for (q = (volatile uint8_t*)st; q < (volatile uint8_t*)en; q += pg) *q = 0;
+			done += en - st;
+		}
+	}
+	pf->done = done;
+	pf->t = realtime() - t;
+	return 0;
+}
+
 uint32_t SA_checksum(int64_t len, const int32_t *s)
 {
 	uint32_t h = 2166136261U;
 	int64_t i;
+	const char *ph = rsslog_phase("checksum");
 	for (i = 0; i < len; ++i)
 		h ^= s[i], h *= 16777619;
+	rsslog_phase(ph);
 	return h;
 }
 
@@ -237,11 +858,66 @@ uint32_t SA_checksum64(int64_t len, const int64_t *s)
 {
 	uint32_t h = 2166136261U;
 	int64_t i;
+	const char *ph = rsslog_phase("checksum");
 	for (i = 0; i < len; ++i)
 		h ^= s[i], h *= 16777619;
+	rsslog_phase(ph);
 	return h;
 }
 
+uint32_t SA_checksum40(int64_t len, const uint8_t *s)
+{
+	uint32_t h = 2166136261U;
+	int64_t i;
+	const char *ph = rsslog_phase("checksum");
+	for (i = 0; i < len; ++i)
+		h ^= ksa_get40(s, i), h *= 16777619;
+	rsslog_phase(ph);
+	return h;
+}
+
+uint32_t BWT_checksum(int64_t len, const uint8_t *s)
+{
+	uint32_t h = 2166136261U;
+	int64_t i;
+	const char *ph = rsslog_phase("checksum");
+	for (i = 0; i < len; ++i)
+		h ^= s[i], h *= 16777619;
+	rsslog_phase(ph);
+	return h;
+}
+
+uint32_t DA_compute64(const uint8_t *s, int64_t *SA, int64_t l)
+{
+	uint32_t h;
+	int32_t *DA = Malloc(int32_t, l);
+	ksa_da64(s, SA, DA, l);
+	h = SA_checksum(l, DA);
+	hm_free(DA);
+	return h;
+}
+
+uint32_t DA_checksum_gsacak(int64_t len, const int_da *DA)
+{
+	uint32_t h = 2166136261U;
+	int64_t i;
+	const char *ph = rsslog_phase("checksum");
+	for (i = 0; i < len; ++i)
+		h ^= (int32_t)DA[i], h *= 16777619;
+	rsslog_phase(ph);
+	return h;
+}
+
+uint32_t SA_finish64(int64_t l, int64_t **SA, int pack40)
+{
+	const char *ph;
+	if (!pack40) return SA_checksum64(l, *SA);
+	ph = rsslog_phase("pack40");
+	*SA = (int64_t*)Realloc(uint8_t, ksa_pack40(*SA, l), l * 5);
+	rsslog_phase(ph);
+	return SA_checksum40(l, (uint8_t*)*SA);
+}
+
 double cputime(void)
 {
 	struct rusage r;
@@ -249,6 +925,117 @@ double cputime(void)
 	return r.ru_utime.tv_sec + r.ru_stime.tv_sec + 1e-6 * (r.ru_utime.tv_usec + r.ru_stime.tv_usec);
 }
 
+/** Print the thread count, CPU model and NUMA nodes, so that runs on different machines can be compared */
+void print_sysinfo(int n_threads)
+{
+	char buf[256], cpu[256] = "unknown", nodes[256];
+	FILE *fp;
+	if ((fp = fopen("/proc/cpuinfo", "r")) != 0) {
+		while (fgets(buf, sizeof(buf), fp))
+			if (strncmp(buf, "model name", 10) == 0 && strchr(buf, ':')) {
+				strncpy(cpu, strchr(buf, ':') + 2, sizeof(cpu) - 1);
+				break;
+			}
+		fclose(fp);
+	}
+	if ((fp = fopen("/sys/devices/system/node/online", "r")) != 0) {
+		if (fgets(nodes, sizeof(nodes), fp) == 0) strcpy(nodes, "unknown");
+		fclose(fp);
+	}
+	cpu[strcspn(cpu, "\n")] = 0, nodes[strcspn(nodes, "\n")] = 0;
+	printf("(MM) Threads: %d; online CPUs: %ld; CPU: %s; NUMA nodes: %s\n", n_threads, sysconf(_SC_NPROCESSORS_ONLN), cpu, nodes);
+}
+
+/** NUMA node of the CPU the calling thread runs on, or -1 if unknown */
+int cur_numa_node(void)
+{
+#ifdef SYS_getcpu
+	unsigned cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, 0) == 0) return node;
+#endif
+	return -1;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+	return x < y? -1 : x > y? 1 : 0;
+}
+
+static void print_stat(const char *name, int n, double *x)
+{
+	double sum = 0.0, sum2 = 0.0, mean;
+	int i;
+	for (i = 0; i < n; ++i) sum += x[i];
+	mean = sum / n;
+	for (i = 0; i < n; ++i) sum2 += (x[i] - mean) * (x[i] - mean);
+	qsort(x, n, sizeof(double), cmp_double);
+	printf("(MM) %s time over %d runs: min %.3f, median %.3f, mean %.3f, stddev %.3f sec\n", name, n, x[0],
+		   n&1? x[n>>1] : (x[(n>>1) - 1] + x[n>>1]) / 2.0, mean, n > 1? sqrt(sum2 / (n - 1)) : 0.0);
+}
+
+/** Print statistics of wall-clock and CPU time, and the NUMA node each run started on; rt and ct are sorted */
+void print_stats(int n, double *rt, double *ct, const int32_t *node)
+{
+	int i;
+	print_stat("Wall-clock", n, rt);
+	print_stat("CPU", n, ct);
+	printf("(MM) NUMA node at the start of each run:");
+	for (i = 0; i < n; ++i) printf("%c%d", i? ',' : ' ', node[i]);
+	putchar('\n');
+}
+
+/** Print the per-stage table recorded when the libraries are compiled with -DSA_PROF */
+void print_prof(double t_run)
+{
+	const saprof_stage_t *st;
+	int i, n = saprof_get(&st);
+	double t_sum = 0.0;
+	if (n == 0) return;
+	printf("(MM) %5s  %-9s  %-12s  %6s  %9s  %6s  %9s\n", "depth", "library", "stage", "calls", "time(s)", "%time", "GB(est)");
+	for (i = 0; i < n; ++i) {
+		printf("(MM) %5d  %-9s  %-12s  %6ld  %9.3f  %6.2f  %9.3f\n", st[i].depth, st[i].lib, st[i].stage, (long)st[i].n_calls,
+			   st[i].t, 100.0 * st[i].t / t_run, st[i].bytes * 1e-9);
+		t_sum += st[i].t;
+	}
+	printf("(MM) Stages cover %.3f of %.3f sec\n", t_sum, t_run);
+}
+
+static void print_perf_line(const char *label, const uint64_t v[PEV_N])
+{
+	int i;
+	printf("(MM) perf  %6s", label);
+	for (i = 0; i < PEV_N; ++i) {
+		if (v[i] == PEV_NA) printf("  %14s", "n/a");
+		else printf("  %14lu", (unsigned long)v[i]);
+	}
+	putchar('\n');
+}
+
+/** Print the counters per thread and in total, and the total per suffix */
+void print_perf(const pev_t *pev, int64_t l)
+{
+	uint64_t v[PEV_N];
+	int t, i, n_threads = pev_n_threads(pev);
+	char label[16];
+	printf("(MM) perf  %6s", "thread");
+	for (i = 0; i < PEV_N; ++i) printf("  %14s", pev_name(i));
+	putchar('\n');
+	for (t = 0; t < n_threads && n_threads > 1; ++t) {
+		pev_read(pev, t, v);
+		snprintf(label, sizeof(label), "%d", t);
+		print_perf_line(label, v);
+	}
+	pev_read(pev, -1, v);
+	print_perf_line("all", v);
+	printf("(MM) perf per suffix:");
+	for (i = 0; i < PEV_N; ++i)
+		if (v[i] != PEV_NA) printf(" %s %.3f;", pev_name(i), (double)v[i] / l);
+	if (v[PEV_CYCLES] != PEV_NA && v[PEV_INSTR] != PEV_NA && v[PEV_CYCLES] > 0)
+		printf(" IPC %.3f", (double)v[PEV_INSTR] / v[PEV_CYCLES]);
+	putchar('\n');
+}
+
 long peakrss(void)
 {
 	struct rusage r;
@@ -270,3 +1057,35 @@ double realtime(void)
 	if (realtime0 < 0.0) realtime0 = t;
 	return t - realtime0;
 }
+
+/** Print the NUMA nodes and the CPUs of pinned threads, so that the placement of runs can be reproduced */
+void print_numa(int n_pinned)
+{
+	const char *policy[] = { "first touch by any thread", "interleaved", "first touch by working threads" };
+	int i;
+	printf("(MM) NUMA nodes:");
+	for (i = 0; i < nm_n_nodes(); ++i)
+		printf("%s node%d (CPUs %s)", i? ";" : "", nm_node_id(i), nm_node_cpus(i));
+	printf("; placement: %s\n", policy[nm_policy()]);
+	if (n_pinned > 0) {
+		printf("(MM) Pinned %d threads to CPUs", n_pinned);
+		for (i = 0; i < n_pinned; ++i)
+			printf("%c%d", i? ',' : ' ', nm_thread_cpu(i));
+		putchar('\n');
+	}
+}
+
+/** Print the share of pages on each node, sampled from [p, p+len); p == 0 takes the largest array freed since the last call */
+void print_layout(const char *name, const void *p, size_t len)
+{
+	size_t cnt[NM_MAX_NODES], n = 0;
+	int i;
+	if (p == 0) len = nm_largest(cnt);
+	else nm_layout(p, len, cnt);
+	for (i = 0; i < nm_n_nodes(); ++i) n += cnt[i];
+	if (len == 0 || n == 0) return;
+	printf("(MM) Node layout of %s (%.3f MB):", name, len / 1024.0 / 1024.0);
+	for (i = 0; i < nm_n_nodes(); ++i)
+		printf("%s node%d %.1f%%", i? ";" : "", nm_node_id(i), 100.0 * cnt[i] / n);
+	putchar('\n');
+}
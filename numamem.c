@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "numamem.h"
+
+#define NM_SAMPLES    4096 // pages queried by nm_layout()
+#define NM_MAX_CPUS   1024
+
+#define MPOL_INTERLEAVE_ 3      // from <linux/mempolicy.h>; libnuma is not needed
+#define MPOL_MF_MOVE_    (1<<1)
+
+typedef struct {
+	int policy, n_threads, pin, n_nodes;
+	int id[NM_MAX_NODES];
+	char cpus[NM_MAX_NODES][256];
+	int n_cpu[NM_MAX_NODES], *cpu[NM_MAX_NODES]; // allowed CPUs of each node
+	int tcpu[NM_MAX_CPUS];                       // CPU of each pinned thread
+	size_t large_len, large_cnt[NM_MAX_NODES];
+} numamem_t;
+
+static numamem_t nm;
+
+/** Parse a list like "0-3,8,10-11" to an array of at most max numbers; return the count */
+static int nm_parse_list(const char *s, int *a, int max)
+{
+	int n = 0;
+	while (*s && *s != '\n') {
+		char *q;
+		long i, st = strtol(s, &q, 10), en = st;
+		if (q == s) break;
+		if (*q == '-') s = q + 1, en = strtol(s, &q, 10);
+		for (i = st; i <= en && n < max; ++i) a[n++] = i;
+		s = *q == ',' ? q + 1 : q;
+	}
+	return n;
+}
+
+static int nm_read_line(const char *fn, char *buf, int size)
+{
+	FILE *fp;
+	int ret = -1;
+	if ((fp = fopen(fn, "r")) == 0) return -1;
+	if (fgets(buf, size, fp)) buf[strcspn(buf, "\n")] = 0, ret = 0;
+	fclose(fp);
+	return ret;
+}
+
+int nm_init(int policy, int n_threads, int pin)
+{
+	static int ids[NM_MAX_NODES], cpus[NM_MAX_CPUS];
+	char buf[1024], fn[256];
+	cpu_set_t allowed;
+	int i, j, n_ids;
+	nm.policy = policy, nm.n_threads = n_threads > 0? n_threads : 1, nm.pin = pin;
+	for (i = 0; i < NM_MAX_CPUS; ++i) nm.tcpu[i] = -1;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		CPU_ZERO(&allowed);
+		for (i = 0; i < sysconf(_SC_NPROCESSORS_ONLN) && i < CPU_SETSIZE; ++i) CPU_SET(i, &allowed);
+	}
+	n_ids = nm_read_line("/sys/devices/system/node/online", buf, sizeof(buf)) == 0? nm_parse_list(buf, ids, NM_MAX_NODES) : 0;
+	for (i = 0; i < n_ids; ++i) {
+		int k = nm.n_nodes, n_cpus, n = 0;
+		snprintf(fn, sizeof(fn), "/sys/devices/system/node/node%d/cpulist", ids[i]);
+		if (nm_read_line(fn, nm.cpus[k], sizeof(nm.cpus[k])) < 0) continue;
+		n_cpus = nm_parse_list(nm.cpus[k], cpus, NM_MAX_CPUS);
+		nm.cpu[k] = (int*)malloc((n_cpus > 0? n_cpus : 1) * sizeof(int));
+		for (j = 0; j < n_cpus; ++j)
+			if (cpus[j] < CPU_SETSIZE && CPU_ISSET(cpus[j], &allowed))
+				nm.cpu[k][n++] = cpus[j];
+		if (n == 0) { // memory-only node or not allowed
+			free(nm.cpu[k]);
+			continue;
+		}
+		nm.id[k] = ids[i], nm.n_cpu[k] = n;
+		++nm.n_nodes;
+	}
+	if (nm.n_nodes == 0) { // no sysfs: one node with all allowed CPUs
+		nm.cpu[0] = (int*)malloc(CPU_SETSIZE * sizeof(int));
+		for (i = 0, j = 0; i < CPU_SETSIZE; ++i)
+			if (CPU_ISSET(i, &allowed)) nm.cpu[0][j++] = i;
+		nm.id[0] = 0, nm.n_cpu[0] = j, nm.n_nodes = 1;
+		strcpy(nm.cpus[0], "unknown");
+	}
+	for (i = 0; i < NM_MAX_CPUS; ++i) { // thread i goes to node i%n_nodes, round-robin over the CPUs of the node
+		int k = i % nm.n_nodes, r = i / nm.n_nodes;
+		nm.tcpu[i] = nm.n_cpu[k] > 0? nm.cpu[k][r % nm.n_cpu[k]] : -1;
+	}
+	return nm.n_nodes;
+}
+
+int nm_policy(void)
+{
+	return nm.policy;
+}
+
+int nm_pin(void)
+{
+	int n_pinned = 0;
+	if (!nm.pin || nm.n_nodes == 0) return 0;
+#ifdef _OPENMP
+	#pragma omp parallel num_threads(nm.n_threads) reduction(+:n_pinned)
+#endif
+	{
+		int i = 0;
+		cpu_set_t set;
+#ifdef _OPENMP
+		i = omp_get_thread_num();
+#endif
+		CPU_ZERO(&set);
+		if (i < NM_MAX_CPUS && nm.tcpu[i] >= 0) {
+			CPU_SET(nm.tcpu[i], &set);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) ++n_pinned;
+		}
+	}
+	return n_pinned;
+}
+
+void nm_place(void *p, size_t len, size_t off)
+{
+	if (off >= len) return;
+	if (nm.policy == NM_INTERLEAVE && nm.n_nodes > 1) { // also move pages already in place, e.g. the text grown to SA
+#ifdef SYS_mbind
+		unsigned long mask = 0;
+		int k;
+		for (k = 0; k < nm.n_nodes; ++k)
+			if (nm.id[k] < 64) mask |= 1UL << nm.id[k];
+		syscall(SYS_mbind, p, len, MPOL_INTERLEAVE_, &mask, 65UL, off? MPOL_MF_MOVE_ : 0);
+#endif
+	}
+}
+
+void nm_touch(void *p, size_t len, size_t off)
+{
+	int t;
+	size_t pg = sysconf(_SC_PAGESIZE);
+	if (nm.policy != NM_TOUCH || off >= len) return;
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(nm.n_threads) schedule(static, 1)
+#endif
+	for (t = 0; t < nm.n_threads; ++t) { // thread t takes [len*t/n, len*(t+1)/n), as "omp for schedule(static)" splits an array
+		size_t st = len * t / nm.n_threads, en = len * (t + 1) / nm.n_threads;
+		uintptr_t a = ((uintptr_t)p + (st > off? st : off) + pg - 1) / pg * pg; // pages starting in the range
+		for (; a < (uintptr_t)p + en; a += pg) *(volatile uint8_t*)a = 0;
+	}
+}
+
+size_t nm_layout(const void *p, size_t len, size_t cnt[NM_MAX_NODES])
+{
+	size_t i, pg = sysconf(_SC_PAGESIZE), n_pg = len / pg, n = n_pg < NM_SAMPLES? n_pg : NM_SAMPLES, n_res = 0;
+	void *pages[NM_SAMPLES];
+	int status[NM_SAMPLES], k;
+	memset(cnt, 0, NM_MAX_NODES * sizeof(size_t));
+	if (n == 0) return 0;
+	for (i = 0; i < n; ++i)
+		pages[i] = (void*)(((uintptr_t)p + n_pg * i / n * pg) / pg * pg);
+#ifdef SYS_move_pages
+	if (syscall(SYS_move_pages, 0, n, pages, 0, status, 0) != 0) return 0;
+	for (i = 0; i < n; ++i) {
+		if (status[i] < 0) continue; // not resident
+		for (k = 0; k < nm.n_nodes; ++k)
+			if (nm.id[k] == status[i]) break;
+		if (k < nm.n_nodes) ++cnt[k], ++n_res;
+	}
+#else
+	(void)status, (void)k;
+#endif
+	return n_res;
+}
+
+void nm_note(const void *p, size_t len)
+{
+	if (len <= nm.large_len || nm.n_nodes == 0) return;
+	nm.large_len = len;
+	nm_layout(p, len, nm.large_cnt);
+}
+
+size_t nm_largest(size_t cnt[NM_MAX_NODES])
+{
+	size_t len = nm.large_len;
+	memcpy(cnt, nm.large_cnt, sizeof(nm.large_cnt));
+	nm.large_len = 0;
+	return len;
+}
+
+int nm_n_nodes(void)
+{
+	return nm.n_nodes;
+}
+
+int nm_node_id(int i)
+{
+	return nm.id[i];
+}
+
+const char *nm_node_cpus(int i)
+{
+	return nm.cpus[i];
+}
+
+int nm_thread_cpu(int i)
+{
+	return nm.pin && i < NM_MAX_CPUS? nm.tcpu[i] : -1;
+}
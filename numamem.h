@@ -0,0 +1,77 @@
+#ifndef NUMAMEM_H
+#define NUMAMEM_H
+
+#include <stddef.h>
+
+#define NM_NONE       0 // kernel default: a page goes to the node of the thread that touches it first
+#define NM_INTERLEAVE 1 // pages of large blocks are interleaved across nodes
+#define NM_TOUCH      2 // arrays are first touched by the OpenMP threads that work on them; see nm_touch()
+
+#define NM_MAX_NODES 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Read the node layout of the CPUs this process may run on and set the placement policy
+ *
+ * @param policy     NM_NONE, NM_INTERLEAVE or NM_TOUCH
+ * @param n_threads  number of OpenMP threads for NM_TOUCH and pinning
+ * @param pin        pin threads in nm_pin()
+ *
+ * @return the number of nodes with allowed CPUs; 1 if the layout is unknown
+ */
+int nm_init(int policy, int n_threads, int pin);
+
+int nm_policy(void);
+
+/**
+ * Pin the OpenMP threads of the calling thread's team to one CPU each,
+ * spreading consecutive threads over nodes; a no-op unless nm_init() was
+ * given pin. libgomp keeps a pool per calling thread, so each thread that
+ * starts parallel regions should call this once.
+ *
+ * @return the number of threads pinned, or 0
+ */
+int nm_pin(void);
+
+/** Apply the policy to a new page-aligned mapping of len bytes; the first off bytes are already in place */
+void nm_place(void *p, size_t len, size_t off);
+
+/**
+ * With NM_TOUCH, first touch the pages of an array before it is used
+ *
+ * The array is split over the threads the way "omp for schedule(static)"
+ * splits it, which is how libsais and text2int() divide SA and the text, so
+ * call this once per logical array, not per allocation. Pages are touched by
+ * writing 0; pages starting before byte off hold data and are left alone.
+ *
+ * @param p    start of the array
+ * @param len  size of the array in bytes
+ * @param off  bytes at the start of the array already in use
+ */
+void nm_touch(void *p, size_t len, size_t off);
+
+/** Count pages of [p, p+len) on each node by sampling; return the number of resident pages sampled */
+size_t nm_layout(const void *p, size_t len, size_t cnt[NM_MAX_NODES]);
+
+/** Sample the layout of a block if it is the largest noted so far, e.g. right before the block is freed */
+void nm_note(const void *p, size_t len);
+
+/** Layout of the largest block noted since the last call; return its size, or 0 if there is none */
+size_t nm_largest(size_t cnt[NM_MAX_NODES]);
+
+/** Number of nodes with allowed CPUs, their IDs and CPU lists as in sysfs */
+int nm_n_nodes(void);
+int nm_node_id(int i);
+const char *nm_node_cpus(int i);
+
+/** CPU thread i is pinned to, or -1 */
+int nm_thread_cpu(int i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <string.h>
+#include "perfev.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+struct pev_s {
+	int n_threads;
+	int (*fd)[PEV_N]; // fd[tid][event]; -1 if not available
+};
+
+static const char *pev_names[PEV_N] = { "cycles", "instructions", "LLC-misses", "dTLB-misses", "branch-misses" };
+
+const char *pev_name(int i)
+{
+	return i >= 0 && i < PEV_N? pev_names[i] : 0;
+}
+
+#ifdef __linux__
+#define PEV_CACHE(c, op, r) ((c) | (op) << 8 | (r) << 16)
+
+static int pev_open1(int i)
+{
+	struct perf_event_attr a;
+	memset(&a, 0, sizeof(a));
+	a.size = sizeof(a);
+	a.disabled = 1, a.exclude_kernel = 1, a.exclude_hv = 1;
+	a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	if (i == PEV_CYCLES) a.type = PERF_TYPE_HARDWARE, a.config = PERF_COUNT_HW_CPU_CYCLES;
+	else if (i == PEV_INSTR) a.type = PERF_TYPE_HARDWARE, a.config = PERF_COUNT_HW_INSTRUCTIONS;
+	else if (i == PEV_BR_MISS) a.type = PERF_TYPE_HARDWARE, a.config = PERF_COUNT_HW_BRANCH_MISSES;
+	else if (i == PEV_LLC_MISS) a.type = PERF_TYPE_HW_CACHE, a.config = PEV_CACHE(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+	else a.type = PERF_TYPE_HW_CACHE, a.config = PEV_CACHE(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+	return syscall(SYS_perf_event_open, &a, 0, -1, -1, 0); // this thread on any CPU
+}
+
+pev_t *pev_open(int n_threads)
+{
+	pev_t *p;
+	int t, i, n_ok = 0;
+	if (n_threads < 1) n_threads = 1;
+#ifndef _OPENMP
+	n_threads = 1;
+#endif
+	p = (pev_t*)calloc(1, sizeof(*p));
+	p->n_threads = n_threads;
+	p->fd = (int(*)[PEV_N])malloc(n_threads * sizeof(*p->fd));
+	memset(p->fd, 0xff, n_threads * sizeof(*p->fd)); // -1 for threads that the team doesn't have
+#ifdef _OPENMP
+	#pragma omp parallel num_threads(n_threads)
+	{
+		int tid = omp_get_thread_num(), j;
+		for (j = 0; j < PEV_N; ++j)
+			p->fd[tid][j] = pev_open1(j);
+	}
+#else
+	for (i = 0; i < PEV_N; ++i) p->fd[0][i] = pev_open1(i);
+#endif
+	for (t = 0; t < n_threads; ++t)
+		for (i = 0; i < PEV_N; ++i)
+			n_ok += p->fd[t][i] >= 0;
+	if (n_ok == 0) {
+		pev_close(p);
+		return 0;
+	}
+	return p;
+}
+
+void pev_start(pev_t *p)
+{
+	int t, i;
+	for (t = 0; t < p->n_threads; ++t)
+		for (i = 0; i < PEV_N; ++i)
+			if (p->fd[t][i] >= 0) {
+				ioctl(p->fd[t][i], PERF_EVENT_IOC_RESET, 0);
+				ioctl(p->fd[t][i], PERF_EVENT_IOC_ENABLE, 0);
+			}
+}
+
+void pev_stop(pev_t *p)
+{
+	int t, i;
+	for (t = 0; t < p->n_threads; ++t)
+		for (i = 0; i < PEV_N; ++i)
+			if (p->fd[t][i] >= 0) ioctl(p->fd[t][i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+static uint64_t pev_read1(int fd)
+{
+	uint64_t v[3]; // value, time enabled, time running
+	if (fd < 0 || read(fd, v, sizeof(v)) != sizeof(v)) return PEV_NA;
+	if (v[2] == 0) return 0;
+	return v[2] < v[1]? (uint64_t)((double)v[0] * v[1] / v[2] + .499) : v[0];
+}
+
+void pev_read(const pev_t *p, int tid, uint64_t val[PEV_N])
+{
+	int t, i;
+	for (i = 0; i < PEV_N; ++i) {
+		val[i] = PEV_NA;
+		for (t = tid < 0? 0 : tid; t < (tid < 0? p->n_threads : tid + 1); ++t) {
+			uint64_t x = pev_read1(p->fd[t][i]);
+			if (x != PEV_NA) val[i] = val[i] == PEV_NA? x : val[i] + x;
+		}
+	}
+}
+
+void pev_close(pev_t *p)
+{
+	int t, i;
+	if (p == 0) return;
+	for (t = 0; t < p->n_threads; ++t)
+		for (i = 0; i < PEV_N; ++i)
+			if (p->fd[t][i] >= 0) close(p->fd[t][i]);
+	free(p->fd);
+	free(p);
+}
+#else // not Linux
+pev_t *pev_open(int n_threads) { return 0; }
+void pev_start(pev_t *p) {}
+void pev_stop(pev_t *p) {}
+void pev_read(const pev_t *p, int tid, uint64_t val[PEV_N]) {}
+void pev_close(pev_t *p) {}
+#endif
+
+int pev_n_threads(const pev_t *p)
+{
+	return p->n_threads;
+}
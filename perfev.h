@@ -0,0 +1,59 @@
+#ifndef PERFEV_H
+#define PERFEV_H
+
+#include <stdint.h>
+
+#define PEV_CYCLES     0
+#define PEV_INSTR      1
+#define PEV_LLC_MISS   2
+#define PEV_DTLB_MISS  3
+#define PEV_BR_MISS    4
+#define PEV_N          5
+
+#define PEV_NA UINT64_MAX // value of an event that can't be counted
+
+typedef struct pev_s pev_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open hardware counters of user-space events on each thread of the OpenMP
+ * team of n_threads threads, the calling thread being thread 0
+ *
+ * Counters of a thread are attached to the OpenMP worker running as that
+ * thread number; they follow the work as long as later parallel regions reuse
+ * the same workers, which is what libgomp does for teams of the same size.
+ *
+ * @return the counters, or NULL if none of the events can be counted, e.g.
+ *         without perf_event_open() or with a high perf_event_paranoid
+ */
+pev_t *pev_open(int n_threads);
+
+/** Reset and start all counters */
+void pev_start(pev_t *p);
+
+/** Stop all counters */
+void pev_stop(pev_t *p);
+
+/** Number of threads with counters */
+int pev_n_threads(const pev_t *p);
+
+/**
+ * Read the counters of thread tid, or the sum over all threads if tid < 0
+ *
+ * Counts are scaled by the time the counter was running if the kernel
+ * multiplexed it. An event that can't be counted is PEV_NA.
+ */
+void pev_read(const pev_t *p, int tid, uint64_t val[PEV_N]);
+
+const char *pev_name(int i);
+
+void pev_close(pev_t *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
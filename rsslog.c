@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "rsslog.h"
+
+#define RL_MAX_PHASES 64
+
+typedef struct {
+	double t;
+	int64_t rss;
+	const char *phase;
+} rss_sample_t;
+
+static struct {
+	int running, stop, interval_ms;
+	char *fn;
+	const char *phase;
+	double t0;
+	size_t n, m;
+	rss_sample_t *a;
+	pthread_t tid;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} rl = { 0, 0, 0, 0, 0, 0.0, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static double rl_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int64_t rl_rss(void)
+{
+	long size, resident = -1;
+	FILE *fp;
+	if ((fp = fopen("/proc/self/statm", "r")) == 0) return -1;
+	if (fscanf(fp, "%ld%ld", &size, &resident) != 2) resident = -1;
+	fclose(fp);
+	return resident < 0? -1 : (int64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+static void rl_sample(void) // with rl.lock held
+{
+	rss_sample_t *s;
+	if (rl.n == rl.m) {
+		rss_sample_t *a;
+		size_t m = rl.m? rl.m * 2 : 1024;
+		if ((a = (rss_sample_t*)realloc(rl.a, m * sizeof(*a))) == 0) return;
+		rl.a = a, rl.m = m;
+	}
+	s = &rl.a[rl.n++];
+	s->t = rl_time() - rl.t0, s->rss = rl_rss(), s->phase = rl.phase;
+}
+
+static void *rl_worker(void *data)
+{
+	pthread_mutex_lock(&rl.lock);
+	while (!rl.stop) {
+		struct timespec ts;
+		rl_sample();
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += (long)rl.interval_ms * 1000000L;
+		ts.tv_sec += ts.tv_nsec / 1000000000L, ts.tv_nsec %= 1000000000L;
+		pthread_cond_timedwait(&rl.cond, &rl.lock, &ts);
+	}
+	pthread_mutex_unlock(&rl.lock);
+	return 0;
+}
+
+int rsslog_start(const char *fn, int interval_ms)
+{
+	rl.fn = strdup(fn);
+	rl.interval_ms = interval_ms > 0? interval_ms : 1;
+	rl.phase = "start", rl.t0 = rl_time(), rl.stop = 0;
+	if (pthread_create(&rl.tid, 0, rl_worker, 0) != 0) return -1;
+	rl.running = 1;
+	return 0;
+}
+
+const char *rsslog_phase(const char *phase)
+{
+	const char *old;
+	if (!rl.running) return 0;
+	pthread_mutex_lock(&rl.lock);
+	old = rl.phase, rl.phase = phase;
+	rl_sample();
+	pthread_mutex_unlock(&rl.lock);
+	return old;
+}
+
+void rsslog_stop(void)
+{
+	size_t i, j, n_ph, peak[RL_MAX_PHASES];
+	FILE *fp;
+	if (!rl.running) return;
+	pthread_mutex_lock(&rl.lock);
+	rl.stop = 1, rl.phase = "end";
+	rl_sample();
+	pthread_cond_signal(&rl.cond);
+	pthread_mutex_unlock(&rl.lock);
+	pthread_join(rl.tid, 0);
+	rl.running = 0;
+	if ((fp = fopen(rl.fn, "w")) != 0) {
+		fprintf(fp, "time_s,rss_mb,phase\n");
+		for (i = 0; i < rl.n; ++i)
+			fprintf(fp, "%.4f,%.3f,%s\n", rl.a[i].t, rl.a[i].rss / 1048576.0, rl.a[i].phase);
+		fclose(fp);
+		printf("(MM) Wrote %ld RSS samples to '%s'\n", (long)rl.n, rl.fn);
+	} else fprintf(stderr, "(EE) Failed to write the RSS timeline to '%s'.\n", rl.fn);
+	for (i = 0, n_ph = 0; i < rl.n; ++i) { // peak of each phase, in the order of their first appearance
+		for (j = 0; j < n_ph; ++j)
+			if (strcmp(rl.a[peak[j]].phase, rl.a[i].phase) == 0) break;
+		if (j == n_ph) {
+			if (n_ph == RL_MAX_PHASES) continue;
+			peak[n_ph++] = i;
+		} else if (rl.a[i].rss > rl.a[peak[j]].rss) peak[j] = i;
+	}
+	for (j = 0; j < n_ph; ++j)
+		printf("(MM) RSS peak during %-9s %10.3f MB at %.3f sec\n", rl.a[peak[j]].phase, rl.a[peak[j]].rss / 1048576.0, rl.a[peak[j]].t);
+	free(rl.a); free(rl.fn);
+	rl.a = 0, rl.n = rl.m = 0, rl.fn = 0;
+}
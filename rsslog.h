@@ -0,0 +1,34 @@
+#ifndef RSSLOG_H
+#define RSSLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start a thread sampling the resident set size every interval_ms milliseconds
+ *
+ * Samples are kept in memory and written to fn as CSV by rsslog_stop(), so
+ * that writing doesn't perturb the timeline.
+ *
+ * @return 0 on success, or -1 if the thread can't be started
+ */
+int rsslog_start(const char *fn, int interval_ms);
+
+/**
+ * Set the phase that following samples are tagged with; phase must be a
+ * static string. A sample is also taken right away, so short phases are seen.
+ * This is a no-op if the sampler is not running.
+ *
+ * @return the previous phase, or NULL
+ */
+const char *rsslog_phase(const char *phase);
+
+/** Stop sampling, write the CSV and print the peak RSS of each phase to stdout */
+void rsslog_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
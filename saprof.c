@@ -0,0 +1,55 @@
+#include <string.h>
+#include <time.h>
+#include "saprof.h"
+
+#define SAPROF_MAX 256
+
+static saprof_stage_t saprof_stages[SAPROF_MAX];
+static int saprof_n, saprof_depth;
+
+double saprof_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void saprof_add(const char *lib, const char *stage, double t, int64_t bytes)
+{
+	int i;
+	saprof_stage_t *p;
+	for (i = 0; i < saprof_n; ++i) {
+		p = &saprof_stages[i];
+		if (p->depth == saprof_depth && strcmp(p->stage, stage) == 0 && strcmp(p->lib, lib) == 0)
+			break;
+	}
+	if (i == saprof_n) {
+		if (saprof_n == SAPROF_MAX) return;
+		p = &saprof_stages[saprof_n++];
+		p->lib = lib, p->stage = stage, p->depth = saprof_depth;
+		p->n_calls = 0, p->t = 0.0, p->bytes = 0;
+	}
+	p = &saprof_stages[i];
+	++p->n_calls, p->t += t, p->bytes += bytes;
+}
+
+void saprof_enter(void)
+{
+	++saprof_depth;
+}
+
+void saprof_leave(void)
+{
+	--saprof_depth;
+}
+
+void saprof_reset(void)
+{
+	saprof_n = saprof_depth = 0;
+}
+
+int saprof_get(const saprof_stage_t **stages)
+{
+	*stages = saprof_stages;
+	return saprof_n;
+}
@@ -0,0 +1,57 @@
+#ifndef SAPROF_H
+#define SAPROF_H
+
+#include <stdint.h>
+
+/*
+ * Optional per-stage timing of suffix array construction. Stages are timed
+ * with a lap timer local to each recursion level. With -DSA_PROF, the stages
+ * are accumulated by stage name and recursion depth; otherwise the macros
+ * expand to nothing. Bytes are estimated from the sizes of the sequential
+ * passes over the text and SA, not measured. The instrumented sources only
+ * include this header with -DSA_PROF and define the empty macros themselves
+ * otherwise, so they build without saprof.c.
+ */
+
+typedef struct {
+	const char *lib, *stage; // static strings
+	int depth;               // recursion depth; 0 for the input text
+	int64_t n_calls;
+	double t;                // wall-clock time in seconds
+	int64_t bytes;           // estimated bytes of the text and SA read or written
+} saprof_stage_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+double saprof_time(void);
+void saprof_add(const char *lib, const char *stage, double t, int64_t bytes);
+void saprof_enter(void);
+void saprof_leave(void);
+
+/** Clear all stages; call before each construction */
+void saprof_reset(void);
+
+/** Get the stages in the order they first appeared; return the number of stages */
+int saprof_get(const saprof_stage_t **stages);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef SA_PROF
+#define SAPROF_DECL(v)                    double v = saprof_time()
+#define SAPROF_LAP(v, lib, stage, bytes)  (saprof_add((lib), (stage), saprof_time() - (v), (int64_t)(bytes)), (v) = saprof_time())
+#define SAPROF_SKIP(v)                    ((v) = saprof_time()) // restart the lap without recording it
+#define SAPROF_ENTER()                    saprof_enter()
+#define SAPROF_LEAVE(v)                   (saprof_leave(), SAPROF_SKIP(v)) // the lower levels are not counted again
+#else
+#define SAPROF_DECL(v)
+#define SAPROF_LAP(v, lib, stage, bytes)  ((void)0)
+#define SAPROF_SKIP(v)                    ((void)0)
+#define SAPROF_ENTER()                    ((void)0)
+#define SAPROF_LEAVE(v)                   ((void)0)
+#endif
+
+#endif
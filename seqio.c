@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include "seqio.h"
+
+#define SIO_BATCH   256       // max number of BGZF blocks inflated in one batch; up to 16 MB of output
+#define SIO_RELEASE (16<<20)  // release consumed pages of the mapping every this many bytes
+
+struct sio_file_s {
+	int mode, n_threads, err, fd;
+	const uint8_t *map; // mapped file for SIO_MMAP and SIO_BGZF
+	size_t len, pos;    // file size and the offset of the next byte or BGZF block
+	size_t released;    // pages before this offset have been released
+	gzFile gz;          // for SIO_STREAM
+	uint8_t *out;       // inflated batch of BGZF blocks
+	size_t out_len, out_pos, out_max;
+	size_t blk[SIO_BATCH + 1], obk[SIO_BATCH + 1]; // offsets of the blocks in the batch in the file and in out
+};
+
+/** Size of the BGZF block at p, or 0 if p is not at a complete BGZF block; n is the number of bytes available */
+static size_t bgzf_block_size(const uint8_t *p, size_t n)
+{
+	size_t xlen, i;
+	if (n < 18 || p[0] != 31 || p[1] != 139 || p[2] != 8 || !(p[3] & 4)) return 0;
+	xlen = p[10] | (size_t)p[11] << 8;
+	if (12 + xlen > n) return 0; // the extra field is cut short; subfields below stay within 12 + xlen
+	for (i = 12; i + 4 <= 12 + xlen; i += 4 + (p[i+2] | (size_t)p[i+3] << 8)) { // scan subfields for "BC"
+		if (i + 6 <= 12 + xlen && p[i] == 'B' && p[i+1] == 'C' && p[i+2] == 2 && p[i+3] == 0) {
+			size_t bsize = (p[i+4] | (size_t)p[i+5] << 8) + 1;
+			return bsize <= n && bsize >= 12 + xlen + 8? bsize : 0;
+		}
+	}
+	return 0;
+}
+
+/** Inflate a BGZF block of bsize bytes to exactly olen bytes; CRC is checked by zlib */
+static int bgzf_inflate(const uint8_t *p, size_t bsize, uint8_t *out, size_t olen)
+{
+	z_stream z;
+	uint8_t dummy;
+	int ret;
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, 15 + 16) != Z_OK) return -1;
+	z.next_in = (Bytef*)p, z.avail_in = bsize;
+	z.next_out = olen? out : &dummy, z.avail_out = olen? olen : 1;
+	ret = inflate(&z, Z_FINISH);
+	inflateEnd(&z);
+	return ret == Z_STREAM_END && z.total_out == olen && z.avail_in == 0? 0 : -1;
+}
+
+/** Inflate the next batch of BGZF blocks with multiple threads */
+static int bgzf_fill(sio_file_t *f)
+{
+	int i, n, err = 0;
+	size_t o = 0;
+	for (n = 0; n < SIO_BATCH && f->pos < f->len; ++n) {
+		size_t bs = bgzf_block_size(f->map + f->pos, f->len - f->pos);
+		const uint8_t *q;
+		if (bs == 0) return -1; // truncated file or not BGZF any more
+		q = f->map + f->pos + bs - 4;
+		f->blk[n] = f->pos, f->obk[n] = o;
+		o += q[0] | (size_t)q[1] << 8 | (size_t)q[2] << 16 | (size_t)q[3] << 24; // ISIZE
+		f->pos += bs;
+	}
+	f->blk[n] = f->pos, f->obk[n] = o;
+	if (o > f->out_max) {
+		uint8_t *p;
+		if ((p = (uint8_t*)realloc(f->out, o)) == NULL) return -1;
+		f->out = p, f->out_max = o;
+	}
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(f->n_threads) schedule(dynamic, 16) reduction(|:err)
+#endif
+	for (i = 0; i < n; ++i)
+		if (bgzf_inflate(f->map + f->blk[i], f->blk[i+1] - f->blk[i], f->out + f->obk[i], f->obk[i+1] - f->obk[i]) < 0)
+			err |= 1;
+	f->out_len = o, f->out_pos = 0;
+	return err? -1 : n;
+}
+
+/** Drop consumed pages of the mapping, so that they don't count towards RSS */
+static void sio_release(sio_file_t *f)
+{
+	size_t pg = sysconf(_SC_PAGESIZE), end = f->pos / pg * pg;
+	if (end - f->released < SIO_RELEASE) return;
+	madvise((void*)(f->map + f->released), end - f->released, MADV_DONTNEED);
+	f->released = end;
+}
+
+sio_file_t *sio_open(const char *fn, int n_threads)
+{
+	sio_file_t *f;
+	struct stat st;
+	if ((f = (sio_file_t*)calloc(1, sizeof(*f))) == NULL) return NULL;
+	f->n_threads = n_threads > 0? n_threads : 1;
+	f->fd = strcmp(fn, "-") == 0? dup(STDIN_FILENO) : open(fn, O_RDONLY);
+	if (f->fd < 0) {
+		free(f);
+		return NULL;
+	}
+	if (fstat(f->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, f->fd, 0);
+		if (p != MAP_FAILED) {
+			f->map = (const uint8_t*)p, f->len = st.st_size;
+			madvise(p, f->len, MADV_SEQUENTIAL);
+			if (bgzf_block_size(f->map, f->len) > 0) f->mode = SIO_BGZF;
+			else if (f->len >= 2 && f->map[0] == 31 && f->map[1] == 139) { // gzip but not BGZF
+				munmap(p, f->len);
+				f->map = 0, f->len = 0;
+			} else f->mode = SIO_MMAP;
+		}
+	}
+	if (f->map == 0) {
+		f->mode = SIO_STREAM;
+		if ((f->gz = gzdopen(f->fd, "r")) == NULL) {
+			close(f->fd);
+			free(f);
+			return NULL;
+		}
+		f->fd = -1; // closed by gzclose()
+	}
+	return f;
+}
+
+int sio_read(sio_file_t *f, void *buf, unsigned len)
+{
+	size_t n = 0;
+	if (f->err) return -1;
+	if (f->mode == SIO_STREAM) {
+		int ret = gzread(f->gz, buf, len);
+		if (ret < 0) f->err = 1;
+		return ret;
+	}
+	if (f->mode == SIO_MMAP) {
+		n = f->len - f->pos < len? f->len - f->pos : len;
+		memcpy(buf, f->map + f->pos, n);
+		f->pos += n;
+	} else { // fill buf unless at the end, as kseq takes a short read as EOF
+		while (n < len) {
+			size_t m;
+			if (f->out_pos == f->out_len) {
+				if (f->pos == f->len) break;
+				if (bgzf_fill(f) < 0) {
+					f->err = 1;
+					return -1;
+				}
+				continue; // the batch may be empty
+			}
+			m = f->out_len - f->out_pos < len - n? f->out_len - f->out_pos : len - n;
+			memcpy((uint8_t*)buf + n, f->out + f->out_pos, m);
+			f->out_pos += m, n += m;
+		}
+	}
+	sio_release(f);
+	return (int)n;
+}
+
+int sio_mode(const sio_file_t *f)
+{
+	return f->mode;
+}
+
+int sio_error(const sio_file_t *f)
+{
+	return f->err;
+}
+
+void sio_close(sio_file_t *f)
+{
+	if (f == 0) return;
+	if (f->map) munmap((void*)f->map, f->len);
+	if (f->gz) gzclose(f->gz);
+	if (f->fd >= 0) close(f->fd);
+	free(f->out);
+	free(f);
+}
@@ -0,0 +1,45 @@
+#ifndef SEQIO_H
+#define SEQIO_H
+
+#include <stddef.h>
+
+#define SIO_STREAM 0 // read by zlib on one thread; gzip or pipes
+#define SIO_MMAP   1 // uncompressed file read through mmap()
+#define SIO_BGZF   2 // BGZF blocks inflated in parallel
+
+typedef struct sio_file_s sio_file_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open a file for sequential reading
+ *
+ * A BGZF file is inflated in batches of blocks by n_threads threads; other
+ * gzip files are read with zlib, and uncompressed regular files are mapped
+ * into memory. Consumed pages of the mapping are released as reading goes.
+ *
+ * @param fn         file name
+ * @param n_threads  number of threads for BGZF; ignored if not compiled with OpenMP
+ *
+ * @return the file handler, or NULL if the file can't be opened
+ */
+sio_file_t *sio_open(const char *fn, int n_threads);
+
+/** Read up to len bytes to buf; return the number of bytes read, 0 at the end, or -1 on errors */
+int sio_read(sio_file_t *f, void *buf, unsigned len);
+
+/** Reading mode: SIO_STREAM, SIO_MMAP or SIO_BGZF */
+int sio_mode(const sio_file_t *f);
+
+/** Nonzero if a read has failed, e.g. on a truncated or corrupted file */
+int sio_error(const sio_file_t *f);
+
+void sio_close(sio_file_t *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif